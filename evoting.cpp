@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <ctime>
 #include <vector>
 #include <fstream>
@@ -11,11 +12,484 @@
 #include <cstdlib>
 #include <chrono>
 #include <limits>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <new>
+#include <unordered_set>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sched.h>
 using namespace std;
 using namespace std::chrono;
 
+// ---------------- Allocation counting ----------------
+// With -DEVOTING_ALLOC_CHECK, global operator new counts heap allocations
+// per thread so --alloc-check can verify the vote path. Other builds keep
+// the standard allocator.
+
+#ifdef EVOTING_ALLOC_CHECK
+thread_local unsigned long long allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* block = malloc(size == 0 ? 1 : size);
+    if (block == NULL) throw bad_alloc();
+    return block;
+}
+
+// Kept out of line so the compiler never pairs an inlined free() with new
+[[gnu::noinline]] void operator delete(void* block) noexcept { free(block); }
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* block) noexcept { operator delete(block); }
+void operator delete(void* block, size_t) noexcept { operator delete(block); }
+void operator delete[](void* block, size_t) noexcept { operator delete(block); }
+
+// Nothrow forms (used by e.g. the temporary buffers of stable_sort and
+// inplace_merge) must come from the same allocator as the delete above
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    allocationCount++;
+    return malloc(size == 0 ? 1 : size);
+}
+void* operator new[](size_t size, const nothrow_t& tag) noexcept { return operator new(size, tag); }
+void operator delete(void* block, const nothrow_t&) noexcept { operator delete(block); }
+void operator delete[](void* block, const nothrow_t&) noexcept { operator delete(block); }
+#endif
+
+// ---------------- Asynchronous logger ----------------
+// Producers pack a format pointer and raw arguments into a fixed-size binary
+// record in their own lock-free ring; a background thread formats "{}"
+// placeholders ("{.N}" = N decimals) and writes the text to the sink.
+
+enum LogLevel { LOG_DEBUG = 0, LOG_INFO, LOG_WARN, LOG_ERROR, LOG_ALERT };
+
+const int LOG_RECORD_SIZE = 256;
+const int LOG_RING_CAPACITY = 4096;   // records per thread, power of two
+const int LOG_MAX_THREADS = 256;
+
+struct LogRecord {
+    const char* format;
+    long long timestampUs;
+    unsigned char level;
+    unsigned short payloadSize;
+    char payload[LOG_RECORD_SIZE - sizeof(const char*) - sizeof(long long) - 4];
+};
+
+// Single-producer single-consumer ring owned by one thread at a time. When
+// the owner exits the ring is retired, and the next new thread takes it
+// over together with any records still queued in it.
+struct LogRing {
+    LogRecord slots[LOG_RING_CAPACITY];
+    atomic<size_t> head;   // next record to format (logger thread)
+    atomic<size_t> tail;   // next free slot (producer thread)
+    atomic<bool> retired;
+    LogRing() : head(0), tail(0), retired(false) {}
+};
+
+// Appends typed arguments to a record payload, truncating when full
+class LogEncoder {
+private:
+    LogRecord& record;
+    
+    bool reserve(size_t bytes) {
+        return record.payloadSize + bytes <= sizeof(record.payload);
+    }
+    
+    void putRaw(char tag, const void* data, size_t size) {
+        if (!reserve(size + 1)) return;
+        record.payload[record.payloadSize++] = tag;
+        memcpy(record.payload + record.payloadSize, data, size);
+        record.payloadSize += size;
+    }
+    
+public:
+    LogEncoder(LogRecord& r) : record(r) { record.payloadSize = 0; }
+    
+    void put(const char* text, size_t length) {
+        if (!reserve(2)) return;
+        size_t room = sizeof(record.payload) - record.payloadSize - 2;
+        size_t n = min(min(length, room), (size_t)255);
+        record.payload[record.payloadSize++] = 's';
+        record.payload[record.payloadSize++] = (char)(unsigned char)n;
+        memcpy(record.payload + record.payloadSize, text, n);
+        record.payloadSize += n;
+    }
+    void put(const string& value) { put(value.data(), value.length()); }
+    void put(string_view value) { put(value.data(), value.length()); }
+    void put(const char* value) { put(value, strlen(value)); }
+    void put(char value) { put(&value, 1); }
+    void put(double value) { putRaw('d', &value, sizeof(value)); }
+    void put(float value) { put((double)value); }
+    
+    template <class T>
+    typename enable_if<is_integral<T>::value>::type put(T value) {
+        if (is_signed<T>::value) {
+            long long v = value;
+            putRaw('i', &v, sizeof(v));
+        } else {
+            unsigned long long v = value;
+            putRaw('u', &v, sizeof(v));
+        }
+    }
+    
+    void putAll() {}
+    template <class First, class... Rest>
+    void putAll(const First& first, const Rest&... rest) {
+        put(first);
+        putAll(rest...);
+    }
+};
+
+class AsyncLogger {
+private:
+    atomic<LogRing*> rings[LOG_MAX_THREADS];
+    atomic<int> ringCount;
+    atomic<int> minLevel;
+    atomic<bool> running;
+    atomic<bool> stopping;
+    atomic<unsigned long long> dropped;         // this thread's ring was full
+    atomic<unsigned long long> droppedNoRing;   // every ring owned by a live thread
+    atomic<unsigned long long> drainPasses;
+    thread* worker;
+    atomic<FILE*> sink;        // read by the logger thread; see setSink
+    atomic<bool> decorate;
+    unsigned long long reportedDrops;
+    unsigned long long reportedNoRing;
+    
+    AsyncLogger() : ringCount(0), minLevel(LOG_DEBUG), running(false), stopping(false),
+                    dropped(0), droppedNoRing(0), drainPasses(0), worker(NULL), sink(stdout), decorate(false),
+                    reportedDrops(0), reportedNoRing(0) {
+        for (int i = 0; i < LOG_MAX_THREADS; i++) rings[i].store(NULL);
+    }
+    
+    // This thread's ring, retired again when the thread exits
+    struct RingOwner {
+        LogRing*& ring;
+        bool& exited;
+        RingOwner(LogRing*& r, bool& e) : ring(r), exited(e) {}
+        ~RingOwner() {
+            if (ring != NULL) ring->retired.store(true, memory_order_release);
+            ring = NULL;
+            exited = true;
+        }
+    };
+    
+    static LogRing*& threadRing() {
+        static thread_local LogRing* ring = NULL;
+        return ring;
+    }
+    
+    // Reuse a retired ring before allocating one; NULL once every slot is
+    // owned by a live thread, or while this thread is exiting
+    LogRing* localRing() {
+        LogRing*& ring = threadRing();
+        static thread_local bool exited = false;
+        if (ring != NULL || exited) return ring;
+        static thread_local RingOwner owner(ring, exited);
+        int count = ringCount.load(memory_order_acquire);
+        for (int i = 0; i < count && ring == NULL; i++) {
+            LogRing* candidate = rings[i].load(memory_order_acquire);
+            bool expected = true;
+            if (candidate != NULL && candidate->retired.compare_exchange_strong(expected, false, memory_order_acq_rel)) {
+                ring = candidate;
+            }
+        }
+        if (ring != NULL) return ring;
+        int slot = ringCount.load(memory_order_relaxed);
+        if (slot >= LOG_MAX_THREADS) return NULL;
+        ring = new LogRing();
+        while (slot < LOG_MAX_THREADS) {
+            LogRing* expected = NULL;
+            if (rings[slot].compare_exchange_strong(expected, ring)) {
+                ringCount.fetch_add(1, memory_order_release);
+                break;
+            }
+            slot++;
+        }
+        if (slot >= LOG_MAX_THREADS) {
+            delete ring;
+            ring = NULL;
+        }
+        return ring;
+    }
+    
+    void startWorker() {
+        bool expected = false;
+        if (running.compare_exchange_strong(expected, true)) {
+            stopping.store(false);
+            worker = new thread(&AsyncLogger::run, this);
+        }
+    }
+    
+    static void formatArg(const char*& p, const char* end, int precision, string& out) {
+        if (p >= end) return;
+        char tag = *p++;
+        char buf[64];
+        if (tag == 's') {
+            size_t n = (unsigned char)*p++;
+            out.append(p, n);
+            p += n;
+        } else if (tag == 'i') {
+            long long v;
+            memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+            snprintf(buf, sizeof(buf), "%lld", v);
+            out += buf;
+        } else if (tag == 'u') {
+            unsigned long long v;
+            memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+            snprintf(buf, sizeof(buf), "%llu", v);
+            out += buf;
+        } else if (tag == 'd') {
+            double v;
+            memcpy(&v, p, sizeof(v));
+            p += sizeof(v);
+            snprintf(buf, sizeof(buf), "%.*f", precision, v);
+            out += buf;
+        }
+    }
+    
+    void formatRecord(const LogRecord& record, string& out) {
+        static const char* levelNames[] = {"DEBUG", "INFO ", "WARN ", "ERROR", "ALERT"};
+        if (decorate.load(memory_order_relaxed)) {
+            time_t seconds = (time_t)(record.timestampUs / 1000000);
+            struct tm local;
+            localtime_r(&seconds, &local);
+            char stamp[64];
+            size_t len = strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+            snprintf(stamp + len, sizeof(stamp) - len, ".%06lld %s ",
+                     record.timestampUs % 1000000, levelNames[record.level]);
+            out += stamp;
+        }
+        const char* p = record.payload;
+        const char* end = record.payload + record.payloadSize;
+        for (const char* f = record.format; *f != '\0'; f++) {
+            if (*f == '{') {
+                const char* close = strchr(f, '}');
+                if (close != NULL) {
+                    int precision = (f[1] == '.') ? atoi(f + 2) : 2;
+                    formatArg(p, end, precision, out);
+                    f = close;
+                    continue;
+                }
+            }
+            out += *f;
+        }
+        out += '\n';
+    }
+    
+    // Format and write everything currently queued; returns records written
+    size_t drain(string& buffer) {
+        size_t written = 0;
+        FILE* out = sink.load(memory_order_acquire);
+        int count = ringCount.load(memory_order_acquire);
+        for (int i = 0; i < count; i++) {
+            LogRing* ring = rings[i].load(memory_order_acquire);
+            if (ring == NULL) continue;
+            size_t h = ring->head.load(memory_order_relaxed);
+            size_t t = ring->tail.load(memory_order_acquire);
+            if (h == t) continue;
+            for (size_t k = h; k != t; k++) {
+                formatRecord(ring->slots[k & (LOG_RING_CAPACITY - 1)], buffer);
+            }
+            fwrite(buffer.data(), 1, buffer.size(), out);
+            fflush(out);
+            buffer.clear();
+            ring->head.store(t, memory_order_release);
+            written += t - h;
+        }
+        unsigned long long drops = dropped.load(memory_order_relaxed);
+        if (drops != reportedDrops) {
+            fprintf(out, "[LOG] %llu records dropped (ring full)\n", drops - reportedDrops);
+            fflush(out);
+            reportedDrops = drops;
+        }
+        drops = droppedNoRing.load(memory_order_relaxed);
+        if (drops != reportedNoRing) {
+            fprintf(out, "[LOG] %llu records dropped (more than %d threads logging)\n",
+                    drops - reportedNoRing, LOG_MAX_THREADS);
+            fflush(out);
+            reportedNoRing = drops;
+        }
+        drainPasses.fetch_add(1, memory_order_release);
+        return written;
+    }
+    
+    void run() {
+        string buffer;
+        buffer.reserve(1 << 16);
+        int idleMicros = 50;
+        while (true) {
+            bool stopRequested = stopping.load(memory_order_acquire);
+            if (drain(buffer) > 0) {
+                idleMicros = 50;
+                continue;
+            }
+            if (stopRequested) break;
+            this_thread::sleep_for(microseconds(idleMicros));
+            idleMicros = min(idleMicros * 2, 2000);
+        }
+    }
+    
+public:
+    static AsyncLogger& instance() {
+        static AsyncLogger logger;
+        return logger;
+    }
+    
+    bool enabled(LogLevel level) const {
+        return level >= minLevel.load(memory_order_relaxed);
+    }
+    
+    template <class... Args>
+    void fillRecord(LogRecord& record, LogLevel level, const char* format, const Args&... args) {
+        record.format = format;
+        record.level = (unsigned char)level;
+        record.timestampUs = decorate.load(memory_order_relaxed)
+            ? duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() : 0;
+        LogEncoder encoder(record);
+        encoder.putAll(args...);
+    }
+    
+    // Ring full or no ring: format and write on the calling thread. The line
+    // may appear ahead of records still queued in the rings.
+    template <class... Args>
+    void writeDirect(LogLevel level, const char* format, const Args&... args) {
+        LogRecord record;
+        fillRecord(record, level, format, args...);
+        string line;
+        formatRecord(record, line);
+        FILE* out = sink.load(memory_order_acquire);
+        fwrite(line.data(), 1, line.size(), out);
+        fflush(out);
+    }
+    
+    // Never blocks. If this thread's ring is full, DEBUG and INFO records are
+    // dropped (and counted); WARN and above are written synchronously instead
+    template <class... Args>
+    void write(LogLevel level, const char* format, const Args&... args) {
+        if (!enabled(level)) return;
+        LogRing* ring = localRing();
+        size_t t = 0;
+        bool full = ring == NULL;
+        if (ring != NULL) {
+            if (!running.load(memory_order_relaxed)) startWorker();
+            t = ring->tail.load(memory_order_relaxed);
+            full = t - ring->head.load(memory_order_acquire) >= (size_t)LOG_RING_CAPACITY;
+        }
+        if (full) {
+            if (level >= LOG_WARN) {
+                writeDirect(level, format, args...);
+            } else {
+                (ring == NULL ? droppedNoRing : dropped).fetch_add(1, memory_order_relaxed);
+            }
+            return;
+        }
+        fillRecord(ring->slots[t & (LOG_RING_CAPACITY - 1)], level, format, args...);
+        ring->tail.store(t + 1, memory_order_release);
+    }
+    
+    // Wait until every record queued so far has been written to the sink
+    void flush() {
+        if (!running.load()) return;
+        int count = ringCount.load(memory_order_acquire);
+        for (int i = 0; i < count; i++) {
+            LogRing* ring = rings[i].load(memory_order_acquire);
+            if (ring == NULL) continue;
+            size_t target = ring->tail.load(memory_order_acquire);
+            while (ring->head.load(memory_order_acquire) < target) {
+                this_thread::sleep_for(microseconds(50));
+            }
+        }
+    }
+    
+    void setLevel(LogLevel level) { minLevel.store(level); }
+    LogLevel getLevel() const { return (LogLevel)minLevel.load(); }
+    
+    // Decorated sinks get a timestamp and level prefix on every line. Returns
+    // once the logger thread has stopped using the previous sink, so the
+    // caller may close it.
+    void setSink(FILE* file, bool decorated) {
+        flush();
+        decorate.store(decorated);
+        sink.store(file, memory_order_release);
+        if (!running.load()) return;
+        unsigned long long passes = drainPasses.load(memory_order_acquire);
+        while (drainPasses.load(memory_order_acquire) < passes + 2) {
+            this_thread::sleep_for(microseconds(50));
+        }
+    }
+    
+    unsigned long long getDropped() const { return dropped.load() + droppedNoRing.load(); }
+    
+    // In a forked child the logger thread does not exist: discard the
+    // parent's queued records and let the next write start a new thread.
+    // Only the forking thread survives, so every other ring is retired
+    void afterFork() {
+        int count = ringCount.load();
+        for (int i = 0; i < count; i++) {
+            LogRing* ring = rings[i].load();
+            if (ring == NULL) continue;
+            ring->head.store(ring->tail.load());
+            if (ring != threadRing()) ring->retired.store(true);
+        }
+        worker = NULL;
+        running.store(false);
+        stopping.store(false);
+    }
+    
+    ~AsyncLogger() {
+        if (worker != NULL) {
+            stopping.store(true, memory_order_release);
+            worker->join();
+            delete worker;
+        }
+    }
+};
+
+template <class... Args>
+inline void logDebug(const char* format, const Args&... args) {
+    AsyncLogger::instance().write(LOG_DEBUG, format, args...);
+}
+
+template <class... Args>
+inline void logInfo(const char* format, const Args&... args) {
+    AsyncLogger::instance().write(LOG_INFO, format, args...);
+}
+
+template <class... Args>
+inline void logWarn(const char* format, const Args&... args) {
+    AsyncLogger::instance().write(LOG_WARN, format, args...);
+}
+
+template <class... Args>
+inline void logError(const char* format, const Args&... args) {
+    AsyncLogger::instance().write(LOG_ERROR, format, args...);
+}
+
+template <class... Args>
+inline void logAlert(const char* format, const Args&... args) {
+    AsyncLogger::instance().write(LOG_ALERT, format, args...);
+}
+
+inline void logFlush() {
+    AsyncLogger::instance().flush();
+}
+
 // Simple hash function
-int simpleHash(const string& key, int tableSize) {
+int simpleHash(string_view key, int tableSize) {
     if (tableSize <= 0) return 0;
     unsigned int hash = 0;
     for (size_t i = 0; i < key.length(); i++) {
@@ -24,17 +498,107 @@ int simpleHash(const string& key, int tableSize) {
     return hash % tableSize;
 }
 
-// Generate hash for blockchain
-string generateHash(const string& data) {
+// 32-bit FNV-1a
+inline unsigned int fnv1a32(string_view key) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < key.length(); i++) {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Shard selection hash (FNV-1a), kept independent of simpleHash so that
+// the voters routed to one shard still spread over that shard's buckets
+int shardForVoter(string_view voterID, int shardCount) {
+    if (shardCount <= 1) return 0;
+    return fnv1a32(voterID) % shardCount;
+}
+
+// djb2 digest as lowercase hex into buf (at least 17 bytes); returns its length
+int djb2Hex(string_view data, char* buf) {
     unsigned long hash = 5381;
     for (size_t i = 0; i < data.length(); i++) {
         hash = ((hash << 5) + hash) + static_cast<unsigned char>(data[i]);
     }
-    stringstream ss;
-    ss << hex << hash;
-    return ss.str();
+    return snprintf(buf, 2 * sizeof(hash) + 1, "%lx", hash);
+}
+
+// Generate hash for blockchain
+string generateHash(const string& data) {
+    char buf[2 * sizeof(unsigned long) + 1];
+    int length = djb2Hex(data, buf);
+    return string(buf, length);
 }
 
+// ---------------- Compile-time policies ----------------
+// VotingSystem is assembled from these at compile time (see the presets
+// below BasicVotingSystem); every call is resolved statically.
+
+// Voter hash policies: map a voter ID to a bucket index
+struct SimpleVoterHash {
+    static int index(string_view key, int tableSize) { return simpleHash(key, tableSize); }
+};
+
+// FNV-1a with a final avalanche step; one multiply per byte and one modulo
+struct FnvVoterHash {
+    static int index(string_view key, int tableSize) {
+        if (tableSize <= 0) return 0;
+        unsigned int hash = fnv1a32(key);
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        return hash % tableSize;
+    }
+};
+
+// Block hasher policies: hex digest used for vote, Merkle and header hashes.
+// The two-argument form writes into out, reusing its capacity.
+struct Djb2BlockHasher {
+    static void hash(string_view data, string& out) {
+        char buf[2 * sizeof(unsigned long) + 1];
+        int length = djb2Hex(data, buf);
+        out.assign(buf, length);
+    }
+    static string hash(const string& data) { return generateHash(data); }
+};
+
+struct Fnv64BlockHasher {
+    static void hash(string_view data, string& out) {
+        unsigned long long hash = 14695981039346656037ull;
+        for (size_t i = 0; i < data.length(); i++) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%016llx", hash);
+        out.assign(buf, 16);
+    }
+    static string hash(const string& data) {
+        string out;
+        hash(data, out);
+        return out;
+    }
+};
+
+// Logging sink policies
+struct AsyncLogSink {
+    static bool enabled(LogLevel level) { return AsyncLogger::instance().enabled(level); }
+    template <class... Args>
+    static void write(LogLevel level, const char* format, const Args&... args) {
+        AsyncLogger::instance().write(level, format, args...);
+    }
+    static void flush() { AsyncLogger::instance().flush(); }
+};
+
+// Compiles logging out entirely
+struct NullLogSink {
+    static bool enabled(LogLevel) { return false; }
+    template <class... Args>
+    static void write(LogLevel, const char*, const Args&...) {}
+    static void flush() {}
+};
+
 // SIMPLIFIED ENCRYPTION: Caesar Cipher
 string simpleEncrypt(const string& data, const string& key) {
     string result = data;
@@ -75,7 +639,7 @@ string simpleDecrypt(const string& data, const string& key) {
                 result[i] = 'a' + (data[i] - 'a' - keyValue + 26) % 26;
             }
         } else if (isdigit(data[i])) {
-            result[i] = '0' + (data[i] - '0' - keyValue + 10) % 10;
+            result[i] = '0' + (data[i] - '0' - keyValue % 10 + 10) % 10;
         } else {
             result[i] = data[i];
         }
@@ -83,17 +647,22 @@ string simpleDecrypt(const string& data, const string& key) {
     return result;
 }
 
+// Field limits; ledger entries store IDs and candidate names inline
+const size_t MAX_VOTER_ID_LENGTH = 20;
+const size_t MAX_CANDIDATE_NAME_LENGTH = 31;
+const size_t MAX_VOTER_NAME_LENGTH = 50;
+
 // Input validation
-bool isValidID(const string& id) {
-    if (id.empty() || id.length() > 20) return false;
+bool isValidID(string_view id) {
+    if (id.empty() || id.length() > MAX_VOTER_ID_LENGTH) return false;
     for (size_t i = 0; i < id.length(); i++) {
         if (!isalnum(id[i])) return false;
     }
     return true;
 }
 
-bool isValidName(const string& name) {
-    if (name.empty() || name.length() > 50) return false;
+bool isValidName(string_view name) {
+    if (name.empty() || name.length() > MAX_VOTER_NAME_LENGTH) return false;
     return true;
 }
 
@@ -103,57 +672,227 @@ struct Voter {
     string name;
     bool hasVoted;
     Voter* next;
-    Voter(string id, string n) : voterID(id), name(n), hasVoted(false), next(NULL) {}
+    Voter(string_view id, string_view n) : voterID(id), name(n), hasVoted(false), next(NULL) {}
+};
+
+// Sorted secondary index over one Voter field for case-insensitive prefix search.
+// Each entry carries the first 16 folded key bytes, so sorting and binary search
+// rarely touch the Voter itself. New voters are appended unsorted; the next
+// search sorts them into a small buffer, which is merged into the main array
+// once it outgrows RECENT_LIMIT.
+class VoterSearchIndex {
+private:
+    struct Entry {
+        uint64_t head[2];   // folded key bytes, big-endian, zero padded
+        Voter* voter;
+    };
+    
+    string Voter::* field;
+    vector<Entry> entries;   // sorted
+    vector<Entry> recent;    // sorted, merged into entries when full
+    vector<Entry> pending;   // unsorted, added since the last search
+    static const size_t RECENT_LIMIT = 4096;
+    
+    static int compareFolded(string_view a, string_view b) {
+        size_t n = min(a.size(), b.size());
+        for (size_t i = 0; i < n; i++) {
+            int ca = tolower((unsigned char)a[i]);
+            int cb = tolower((unsigned char)b[i]);
+            if (ca != cb) return ca - cb;
+        }
+        return (a.size() > b.size()) - (a.size() < b.size());
+    }
+    
+    static void foldHead(string_view key, uint64_t head[2]) {
+        for (size_t w = 0; w < 2; w++) {
+            head[w] = 0;
+            for (size_t i = w * 8; i < w * 8 + 8; i++) {
+                head[w] = (head[w] << 8) | (i < key.size() ? (uint64_t)tolower((unsigned char)key[i]) : 0);
+            }
+        }
+    }
+    
+    // Orders like compareFolded on the whole key; the exact voter ID breaks ties
+    static bool before(const Entry& a, const Entry& b, string Voter::* f) {
+        if (a.head[0] != b.head[0]) return a.head[0] < b.head[0];
+        if (a.head[1] != b.head[1]) return a.head[1] < b.head[1];
+        int c = compareFolded(a.voter->*f, b.voter->*f);
+        if (c != 0) return c < 0;
+        return a.voter->voterID < b.voter->voterID;
+    }
+    
+    // Sort on the cached heads alone, then finish each run of equal heads with
+    // full key comparisons so only those runs dereference voters
+    void sortEntries(vector<Entry>& list) {
+        sort(list.begin(), list.end(), [](const Entry& a, const Entry& b) {
+            return a.head[0] != b.head[0] ? a.head[0] < b.head[0] : a.head[1] < b.head[1];
+        });
+        string Voter::* f = field;
+        size_t runStart = 0;
+        for (size_t i = 1; i <= list.size(); i++) {
+            if (i < list.size() && list[i].head[0] == list[runStart].head[0]
+                && list[i].head[1] == list[runStart].head[1]) continue;
+            if (i - runStart > 1) {
+                sort(list.begin() + runStart, list.begin() + i,
+                     [f](const Entry& a, const Entry& b) { return before(a, b, f); });
+            }
+            runStart = i;
+        }
+    }
+    
+    void mergeInto(vector<Entry>& target, vector<Entry>& source) {
+        string Voter::* f = field;
+        size_t middle = target.size();
+        target.insert(target.end(), source.begin(), source.end());
+        inplace_merge(target.begin(), target.begin() + middle, target.end(),
+                      [f](const Entry& a, const Entry& b) { return before(a, b, f); });
+        source.clear();
+    }
+    
+    void refresh() {
+        if (!pending.empty()) {
+            sortEntries(pending);
+            mergeInto(recent, pending);
+        }
+        if (recent.size() > RECENT_LIMIT) {
+            mergeInto(entries, recent);
+        }
+    }
+    
+    // Compares an entry's key, or just its first prefix.size() bytes, with prefix
+    int comparePrefix(const Entry& e, const uint64_t prefixHead[2], string_view prefix, bool truncate) const {
+        for (size_t w = 0; w < 2; w++) {
+            uint64_t head = e.head[w];
+            if (truncate && prefix.size() < w * 8 + 8) {
+                head = prefix.size() <= w * 8 ? 0 : head & (~0ull << (8 * (w * 8 + 8 - prefix.size())));
+            }
+            if (head != prefixHead[w]) return head < prefixHead[w] ? -1 : 1;
+        }
+        string_view key = e.voter->*field;
+        if (truncate) key = key.substr(0, prefix.size());
+        return compareFolded(key, prefix);
+    }
+    
+    // Positions [first, last) in a sorted list whose key starts with prefix
+    pair<size_t, size_t> prefixRange(const vector<Entry>& list, string_view prefix) const {
+        uint64_t prefixHead[2];
+        foldHead(prefix, prefixHead);
+        vector<Entry>::const_iterator first = partition_point(list.begin(), list.end(),
+            [&](const Entry& e) { return comparePrefix(e, prefixHead, prefix, false) < 0; });
+        vector<Entry>::const_iterator last = partition_point(first, list.end(),
+            [&](const Entry& e) { return comparePrefix(e, prefixHead, prefix, true) <= 0; });
+        return make_pair((size_t)(first - list.begin()), (size_t)(last - list.begin()));
+    }
+    
+public:
+    explicit VoterSearchIndex(string Voter::* f) : field(f) {}
+    
+    void add(Voter* voter) {
+        Entry e;
+        foldHead(voter->*field, e.head);
+        e.voter = voter;
+        pending.push_back(e);
+    }
+    
+    void clear() {
+        entries.clear();
+        recent.clear();
+        pending.clear();
+    }
+    
+    // Matches number offset..offset+limit-1 in key order go to out; returns the match count
+    size_t search(string_view prefix, size_t offset, size_t limit, vector<const Voter*>& out) {
+        refresh();
+        pair<size_t, size_t> a = prefixRange(entries, prefix);
+        pair<size_t, size_t> b = prefixRange(recent, prefix);
+        size_t total = (a.second - a.first) + (b.second - b.first);
+        size_t i = a.first, j = b.first;
+        for (size_t rank = 0; rank < offset + limit && rank < total; rank++) {
+            bool fromEntries = j == b.second || (i < a.second && before(entries[i], recent[j], field));
+            const Voter* voter = fromEntries ? entries[i++].voter : recent[j++].voter;
+            if (rank >= offset) out.push_back(voter);
+        }
+        return total;
+    }
 };
 
 // Hash Table for storing voters with dynamic resizing
-class VoterHashTable {
+template <class HashFn, class Log>
+class BasicVoterHashTable {
 private:
     Voter** table;
     int totalVoters;
-    int capacity;
     string encryptionKey;
     const double LOAD_FACTOR_THRESHOLD;
     const int INITIAL_CAPACITY;
+    int capacity;
+    VoterSearchIndex idIndex;
+    VoterSearchIndex nameIndex;
+    vector<Voter*> registrationOrder;
     
+    // Old bucket array while a resize is in progress; buckets below
+    // migrateIndex have already been moved into table
+    Voter** oldTable;
+    int oldCapacity;
+    int migrateIndex;
+    long long migrateMicros;
+    static const int MIGRATE_BUCKETS = 64;
+    
+    // Doubles the bucket array. Chains move over MIGRATE_BUCKETS old buckets
+    // per insert, so no single registration pays for the whole rehash.
     void resizeTable() {
-        auto start = high_resolution_clock::now();
-        int oldCapacity = capacity;
-        Voter** oldTable = table;
+        finishResize();
+        oldTable = table;
+        oldCapacity = capacity;
+        migrateIndex = 0;
+        migrateMicros = 0;
         capacity = capacity * 2;
         table = new Voter*[capacity];
         for (int i = 0; i < capacity; i++) {
             table[i] = NULL;
         }
-        totalVoters = 0;
-        for (int i = 0; i < oldCapacity; i++) {
-            Voter* current = oldTable[i];
+        Log::write(LOG_INFO, "[HASH TABLE] Resizing from {} to {}", oldCapacity, capacity);
+    }
+    
+    void migrateBuckets(int buckets) {
+        if (oldTable == NULL) return;
+        auto start = high_resolution_clock::now();
+        int end = min(oldCapacity, migrateIndex + buckets);
+        for (; migrateIndex < end; migrateIndex++) {
+            Voter* current = oldTable[migrateIndex];
             while (current != NULL) {
                 Voter* next = current->next;
-                int newIndex = simpleHash(current->voterID, capacity);
+                int newIndex = HashFn::index(current->voterID, capacity);
                 current->next = table[newIndex];
                 table[newIndex] = current;
-                totalVoters++;
                 current = next;
             }
+            oldTable[migrateIndex] = NULL;
+        }
+        migrateMicros += duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+        if (migrateIndex == oldCapacity) {
+            delete[] oldTable;
+            oldTable = NULL;
+            Log::write(LOG_INFO, "[HASH TABLE] Resized from {} to {}", oldCapacity, capacity);
+            Log::write(LOG_DEBUG, "             [TIME] Resize operation: {} microseconds (spread over inserts)",
+                       migrateMicros);
         }
-        delete[] oldTable;
-        auto end = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(end - start);
-        cout << "[HASH TABLE] Resized from " << oldCapacity << " to " << capacity << "\n";
-        cout << "             [TIME] Resize operation: " << duration.count() << " microseconds\n";
     }
     
+    void finishResize() { migrateBuckets(oldCapacity); }
+    
 public:
-    VoterHashTable() : totalVoters(0), encryptionKey("VOTE2024"), 
-                       LOAD_FACTOR_THRESHOLD(0.7), INITIAL_CAPACITY(10), capacity(INITIAL_CAPACITY) {
+    BasicVoterHashTable() : totalVoters(0), encryptionKey("VOTE2024"),
+                            LOAD_FACTOR_THRESHOLD(0.7), INITIAL_CAPACITY(10), capacity(INITIAL_CAPACITY),
+                            idIndex(&Voter::voterID), nameIndex(&Voter::name),
+                            oldTable(NULL), oldCapacity(0), migrateIndex(0), migrateMicros(0) {
         table = new Voter*[capacity];
         for (int i = 0; i < capacity; i++) {
             table[i] = NULL;
         }
     }
     
-    void insertVoter(string voterID, string name) {
+    bool insertVoter(string_view voterID, string_view name) {
         auto start = high_resolution_clock::now();
         try {
             if (!isValidID(voterID)) {
@@ -163,34 +902,39 @@ public:
                 throw invalid_argument("Invalid name! Max 50 characters.");
             }
             if (findVoter(voterID) != NULL) {
-                cout << "[ERROR] Voter ID already exists!\n";
-                return;
+                Log::write(LOG_ERROR, "[ERROR] Voter ID already exists!");
+                return false;
             }
             double loadFactor = (double)(totalVoters + 1) / capacity;
             if (loadFactor > LOAD_FACTOR_THRESHOLD) {
-                cout << "[HASH TABLE] Load factor " << fixed << setprecision(2) << loadFactor 
-                     << " > " << LOAD_FACTOR_THRESHOLD << ", resizing...\n";
+                Log::write(LOG_INFO, "[HASH TABLE] Load factor {} > {}, resizing...", loadFactor, LOAD_FACTOR_THRESHOLD);
                 resizeTable();
             }
-            int index = simpleHash(voterID, capacity);
+            migrateBuckets(MIGRATE_BUCKETS);
+            int index = HashFn::index(voterID, capacity);
             Voter* newVoter = new Voter(voterID, name);
             newVoter->next = table[index];
             table[index] = newVoter;
+            idIndex.add(newVoter);
+            nameIndex.add(newVoter);
+            registrationOrder.push_back(newVoter);
             totalVoters++;
             auto end = high_resolution_clock::now();
             auto duration = duration_cast<microseconds>(end - start);
-            cout << "[SUCCESS] Voter registered: " << name << " (ID: " << voterID << ")\n";
-            cout << "          Stored at hash index: " << index << "\n";
-            cout << "          Current capacity: " << capacity << ", Load factor: " 
-                 << fixed << setprecision(2) << (double)totalVoters / capacity << "\n";
-            cout << "          [TIME] Hash Table Insert: " << duration.count() << " microseconds\n";
+            Log::write(LOG_INFO, "[SUCCESS] Voter registered: {} (ID: {})", name, voterID);
+            Log::write(LOG_DEBUG, "          Stored at hash index: {}\n"
+                       "          Current capacity: {}, Load factor: {}\n"
+                       "          [TIME] Hash Table Insert: {} microseconds",
+                       index, capacity, (double)totalVoters / capacity, (long long)duration.count());
+            return true;
         } catch (const exception& e) {
-            cout << "[ERROR] " << e.what() << "\n";
+            Log::write(LOG_ERROR, "[ERROR] {}", e.what());
+            return false;
         }
     }
     
-    Voter* findVoter(string voterID) {
-        int index = simpleHash(voterID, capacity);
+    Voter* findVoter(string_view voterID) const {
+        int index = HashFn::index(voterID, capacity);
         Voter* current = table[index];
         while (current != NULL) {
             if (current->voterID == voterID) {
@@ -198,45 +942,48 @@ public:
             }
             current = current->next;
         }
+        if (oldTable != NULL) {
+            for (current = oldTable[HashFn::index(voterID, oldCapacity)]; current != NULL; current = current->next) {
+                if (current->voterID == voterID) return current;
+            }
+        }
         return NULL;
     }
     
-    bool authenticateVoter(string voterID) {
+    // Returns the voter handle for the rest of the vote, or NULL
+    Voter* authenticateVoter(string_view voterID) {
         auto start = high_resolution_clock::now();
         Voter* voter = findVoter(voterID);
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<microseconds>(end - start);
         if (voter == NULL) {
-            cout << "[ERROR] Voter ID not found!\n";
-            cout << "        [TIME] Hash Table Search: " << duration.count() << " microseconds\n";
-            return false;
+            Log::write(LOG_ERROR, "[ERROR] Voter ID not found!");
+            Log::write(LOG_DEBUG, "        [TIME] Hash Table Search: {} microseconds", (long long)duration.count());
+            return NULL;
         }
-        cout << "[SUCCESS] Welcome, " << voter->name << "!\n";
-        cout << "          [TIME] Hash Table Search: " << duration.count() << " microseconds\n";
-        return true;
+        Log::write(LOG_INFO, "[SUCCESS] Welcome, {}!", voter->name);
+        Log::write(LOG_DEBUG, "          [TIME] Hash Table Search: {} microseconds", (long long)duration.count());
+        return voter;
     }
     
-    bool markAsVoted(string voterID) {
-        Voter* voter = findVoter(voterID);
+    bool markAsVoted(Voter* voter) {
         if (voter == NULL) return false;
         if (voter->hasVoted) return false;
         voter->hasVoted = true;
         return true;
     }
     
+    bool markAsVoted(string_view voterID) { return markAsVoted(findVoter(voterID)); }
+    
     void displayAllVoters() {
         cout << "\n+========================================+\n";
         cout << "|       REGISTERED VOTERS LIST           |\n";
         cout << "+========================================+\n";
-        for (int i = 0; i < capacity; i++) {
-            Voter* current = table[i];
-            while (current != NULL) {
-                cout << "  ID: " << setw(10) << left << current->voterID
-                     << " | Name: " << setw(20) << left << current->name
-                     << " | Voted: " << (current->hasVoted ? "YES" : "NO") << "\n";
-                current = current->next;
-            }
-        }
+        forEachVoter([](const Voter& voter) {
+            cout << "  ID: " << setw(10) << left << voter.voterID
+                 << " | Name: " << setw(20) << left << voter.name
+                 << " | Voted: " << (voter.hasVoted ? "YES" : "NO") << "\n";
+        });
         cout << "\n  Total voters: " << totalVoters << "\n\n";
     }
     
@@ -244,6 +991,7 @@ public:
         cout << "\n+========================================+\n";
         cout << "|     HASH TABLE STATISTICS              |\n";
         cout << "+========================================+\n";
+        finishResize();
         int usedSlots = 0;
         int maxChain = 0;
         int totalChains = 0;
@@ -269,7 +1017,8 @@ public:
              << (double)totalVoters / capacity << " (threshold: " << LOAD_FACTOR_THRESHOLD << ")\n";
         cout << "  Longest Chain: " << maxChain << "\n";
         cout << "  Average Chain Length: " << fixed << setprecision(2) << avgChainLength << "\n";
-        cout << "  Resizing Strategy: Double capacity when load > " << LOAD_FACTOR_THRESHOLD << "\n";
+        cout << "  Resizing Strategy: Double capacity when load > " << LOAD_FACTOR_THRESHOLD
+             << ", rehashing " << MIGRATE_BUCKETS << " old buckets per insert\n";
         cout << "  Average Time Complexity: O(1) for search/insert\n";
         cout << "  Worst Case (with collisions): O(" << maxChain << ")\n\n";
     }
@@ -280,19 +1029,15 @@ public:
             if (!file.is_open()) {
                 throw runtime_error("Cannot open file");
             }
-            for (int i = 0; i < capacity; i++) {
-                Voter* current = table[i];
-                while (current != NULL) {
-                    string encID = simpleEncrypt(current->voterID, encryptionKey);
-                    string encName = simpleEncrypt(current->name, encryptionKey);
-                    file << encID << "|" << encName << "|" << current->hasVoted << "\n";
-                    current = current->next;
-                }
-            }
+            forEachVoter([&](const Voter& voter) {
+                string encID = simpleEncrypt(voter.voterID, encryptionKey);
+                string encName = simpleEncrypt(voter.name, encryptionKey);
+                file << encID << "|" << encName << "|" << voter.hasVoted << "\n";
+            });
             file.close();
             return true;
         } catch (const exception& e) {
-            cout << "[ERROR] Save failed: " << e.what() << "\n";
+            Log::write(LOG_ERROR, "[ERROR] Save failed: {}", e.what());
             return false;
         }
     }
@@ -304,16 +1049,7 @@ public:
             if (!file.is_open()) return false;
             
             // Clear existing data
-            for (int i = 0; i < capacity; i++) {
-                Voter* current = table[i];
-                while (current != NULL) {
-                    Voter* toDelete = current;
-                    current = current->next;
-                    delete toDelete;
-                }
-                table[i] = NULL;
-            }
-            totalVoters = 0;
+            clear();
             
             string line;
             int loadedCount = 0;
@@ -329,7 +1065,7 @@ public:
                 
                 // Validate format
                 if (pos1 == string::npos || pos2 == string::npos || pos1 >= pos2) {
-                    cout << "[WARNING] Skipping invalid line in file\n";
+                    Log::write(LOG_WARN, "[WARNING] Skipping invalid line in file");
                     continue;
                 }
                 
@@ -339,7 +1075,7 @@ public:
                 
                 // Validate encrypted data is not empty
                 if (encID.empty() || encName.empty()) {
-                    cout << "[WARNING] Skipping line with empty data\n";
+                    Log::write(LOG_WARN, "[WARNING] Skipping line with empty data");
                     continue;
                 }
                 
@@ -350,177 +1086,961 @@ public:
                     
                     // Validate decrypted data
                     if (!isValidID(voterID) || !isValidName(name)) {
-                        cout << "[WARNING] Skipping invalid voter data\n";
+                        Log::write(LOG_WARN, "[WARNING] Skipping invalid voter data");
                         continue;
                     }
                     
-                    // Check if resize needed
-                    if ((double)(totalVoters + 1) / capacity > LOAD_FACTOR_THRESHOLD) {
-                        resizeTable();
-                    }
-                    
-                    int index = simpleHash(voterID, capacity);
-                    Voter* newVoter = new Voter(voterID, name);
-                    newVoter->hasVoted = voted;
-                    newVoter->next = table[index];
-                    table[index] = newVoter;
-                    totalVoters++;
+                    addLoadedVoter(voterID, name, voted);
                     loadedCount++;
                     
                 } catch (const exception& e) {
-                    cout << "[WARNING] Error processing voter: " << e.what() << "\n";
+                    Log::write(LOG_WARN, "[WARNING] Error processing voter: {}", e.what());
                     continue;
                 }
             }
             
             file.close();
-            cout << "[INFO] Loaded " << loadedCount << " voters from file\n";
+            Log::write(LOG_INFO, "[INFO] Loaded {} voters from file", loadedCount);
             return true;
             
         } catch (const exception& e) {
-            cout << "[ERROR] Load failed: " << e.what() << "\n";
+            Log::write(LOG_ERROR, "[ERROR] Load failed: {}", e.what());
             return false;
         }
     }
     
-    int getTotalVoters() const { return totalVoters; }
-    
-    int getVotedCount() const {
-        int count = 0;
+    void clear() {
+        for (size_t i = 0; i < registrationOrder.size(); i++) {
+            delete registrationOrder[i];
+        }
         for (int i = 0; i < capacity; i++) {
-            Voter* current = table[i];
-            while (current != NULL) {
-                if (current->hasVoted) count++;
-                current = current->next;
-            }
+            table[i] = NULL;
         }
-        return count;
+        delete[] oldTable;
+        oldTable = NULL;
+        registrationOrder.clear();
+        idIndex.clear();
+        nameIndex.clear();
+        totalVoters = 0;
+    }
+    
+    // Insert without logging or duplicate checks; the caller has validated the data
+    void addLoadedVoter(string_view voterID, string_view name, bool voted) {
+        if ((double)(totalVoters + 1) / capacity > LOAD_FACTOR_THRESHOLD) {
+            resizeTable();
+        }
+        migrateBuckets(MIGRATE_BUCKETS);
+        int index = HashFn::index(voterID, capacity);
+        Voter* newVoter = new Voter(voterID, name);
+        newVoter->hasVoted = voted;
+        newVoter->next = table[index];
+        table[index] = newVoter;
+        idIndex.add(newVoter);
+        nameIndex.add(newVoter);
+        registrationOrder.push_back(newVoter);
+        totalVoters++;
     }
     
-    ~VoterHashTable() {
+    // Every voter, including chains not yet moved out of the old table
+    template <class Func>
+    void forEachVoter(Func f) const {
         for (int i = 0; i < capacity; i++) {
-            Voter* current = table[i];
-            while (current != NULL) {
-                Voter* toDelete = current;
-                current = current->next;
-                delete toDelete;
+            for (const Voter* current = table[i]; current != NULL; current = current->next) {
+                f(*current);
+            }
+        }
+        for (int i = migrateIndex; oldTable != NULL && i < oldCapacity; i++) {
+            for (const Voter* current = oldTable[i]; current != NULL; current = current->next) {
+                f(*current);
             }
         }
-        delete[] table;
     }
-};
-
-// Blockchain block structure
-struct VoteRecord {
-    string voterID;
-    string candidate;
-    time_t timestamp;
-    string hash;
-    string previousHash;
-    VoteRecord* next;
     
-    VoteRecord(string vID, string cand, string prevHash = "0")
-        : voterID(vID), candidate(cand), previousHash(prevHash), next(NULL) {
-        timestamp = time(NULL);
-        hash = calculateHash();
+    // Voters by registration order; stable across resizes, unlike bucket order
+    const Voter* voterAt(int ordinal) const { return registrationOrder[ordinal]; }
+    
+    // Writes the voters.dat lines of voters [from, to) in registration order
+    bool saveRange(FILE* file, int from, int to) const {
+        bool ok = true;
+        for (int i = from; i < to && ok; i++) {
+            const Voter* voter = registrationOrder[i];
+            string line = simpleEncrypt(voter->voterID, encryptionKey) + "|"
+                          + simpleEncrypt(voter->name, encryptionKey) + "|" + (voter->hasVoted ? "1" : "0") + "\n";
+            ok = fwrite(line.data(), 1, line.size(), file) == line.size();
+        }
+        return ok;
     }
     
-    string calculateHash() {
-        stringstream ss;
-        ss << voterID << candidate << timestamp << previousHash;
-        return generateHash(ss.str());
+    // Case-insensitive prefix search; see VoterSearchIndex::search
+    size_t searchByID(string_view prefix, size_t offset, size_t limit, vector<const Voter*>& out) {
+        return idIndex.search(prefix, offset, limit, out);
     }
+    
+    size_t searchByName(string_view prefix, size_t offset, size_t limit, vector<const Voter*>& out) {
+        return nameIndex.search(prefix, offset, limit, out);
+    }
+    
+    string encryptField(const string& value) const { return simpleEncrypt(value, encryptionKey); }
+    string decryptField(const string& value) const { return simpleDecrypt(value, encryptionKey); }
+    
+    int getTotalVoters() const { return totalVoters; }
+    
+    void collectTurnout(vector<pair<string, bool> >& out) const {
+        out.reserve(out.size() + totalVoters);
+        forEachVoter([&](const Voter& voter) {
+            out.push_back(make_pair(voter.voterID, voter.hasVoted));
+        });
+    }
+    
+    int getVotedCount() const {
+        int count = 0;
+        forEachVoter([&](const Voter& voter) {
+            if (voter.hasVoted) count++;
+        });
+        return count;
+    }
+    
+    // Clear every voted flag; returns how many were set
+    int clearVotedFlags() {
+        int cleared = 0;
+        for (size_t i = 0; i < registrationOrder.size(); i++) {
+            if (registrationOrder[i]->hasVoted) cleared++;
+            registrationOrder[i]->hasVoted = false;
+        }
+        return cleared;
+    }
+    
+    ~BasicVoterHashTable() {
+        clear();
+        delete[] table;
+    }
+};
+
+typedef BasicVoterHashTable<SimpleVoterHash, AsyncLogSink> VoterHashTable;
+
+// Run f(part, begin, end) over [0, count) split into contiguous parts, one thread per part
+template <class Func>
+void parallelFor(size_t count, int threads, Func f) {
+    if (threads < 1) threads = 1;
+    if ((size_t)threads > count) threads = count > 0 ? (int)count : 1;
+    if (threads == 1) {
+        f(0, (size_t)0, count);
+        return;
+    }
+    vector<thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        size_t begin = min(count, t * chunk);
+        size_t end = min(count, begin + chunk);
+        workers.push_back(thread(f, t, begin, end));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+}
+
+inline int defaultThreadCount() {
+    unsigned int n = thread::hardware_concurrency();
+    return n == 0 ? 1 : (int)n;
+}
+
+// Histogram of byte values, split across threads. Each thread keeps four
+// interleaved sub-histograms so consecutive increments do not depend on
+// each other; partial counts are merged once at the end.
+inline vector<long long> parallelHistogram(const unsigned char* values, size_t count, int threads) {
+    if (threads < 1) threads = 1;
+    vector<vector<long long> > partial(threads, vector<long long>(256, 0));
+    parallelFor(count, threads, [&](int t, size_t begin, size_t end) {
+        long long sub[4][256];
+        memset(sub, 0, sizeof(sub));
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            sub[0][values[i]]++;
+            sub[1][values[i + 1]]++;
+            sub[2][values[i + 2]]++;
+            sub[3][values[i + 3]]++;
+        }
+        for (; i < end; i++) sub[0][values[i]]++;
+        for (int v = 0; v < 256; v++) {
+            partial[t][v] = sub[0][v] + sub[1][v] + sub[2][v] + sub[3][v];
+        }
+    });
+    vector<long long> histogram(256, 0);
+    for (int t = 0; t < threads; t++) {
+        for (int v = 0; v < 256; v++) histogram[v] += partial[t][v];
+    }
+    return histogram;
+}
+
+// ---------------- Binary encoding helpers ----------------
+// Little-endian fixed-width integers, LEB128 varints (zigzag for signed
+// values) and length-prefixed strings, shared by the export and checkpoint
+// formats.
+
+inline void putVarint(string& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out += (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+inline void putSigned(string& out, long long value) {
+    putVarint(out, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+inline void putFixed(string& out, unsigned long long value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out += (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+inline void putString(string& out, string_view value) {
+    putVarint(out, value.size());
+    out.append(value.data(), value.size());
+}
+
+// Reads the encodings above; throws runtime_error on truncated input
+class ByteReader {
+private:
+    const string& data;
+    size_t pos;
+    
+    void need(size_t bytes) const {
+        if (bytes > data.size() - pos) {
+            throw runtime_error("Unexpected end of data");
+        }
+    }
+    
+public:
+    ByteReader(const string& input) : data(input), pos(0) {}
+    
+    unsigned long long getVarint() {
+        unsigned long long value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            need(1);
+            unsigned char byte = (unsigned char)data[pos++];
+            value |= (unsigned long long)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw runtime_error("Malformed varint");
+    }
+    
+    long long getSigned() {
+        unsigned long long value = getVarint();
+        return (long long)(value >> 1) ^ -(long long)(value & 1);
+    }
+    
+    unsigned long long getFixed(int bytes) {
+        need(bytes);
+        unsigned long long value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= (unsigned long long)(unsigned char)data[pos++] << (8 * i);
+        }
+        return value;
+    }
+    
+    string_view getString() {
+        unsigned long long length = getVarint();
+        need(length);
+        string_view value(data.data() + pos, length);
+        pos += length;
+        return value;
+    }
+    
+    bool expect(string_view literal) {
+        if (data.compare(pos, literal.size(), literal.data(), literal.size()) != 0) return false;
+        pos += literal.size();
+        return true;
+    }
+    
+    size_t remaining() const { return data.size() - pos; }
+    bool atEnd() const { return pos == data.size(); }
 };
 
-// Blockchain ledger
-class VoteLedger {
+// Fixed-capacity string stored inline, so copying one into a vote entry
+// never touches the heap
+template <size_t N>
+struct InlineText {
+    char text[N + 1];
+    unsigned char length;
+    
+    InlineText() : length(0) { text[0] = '\0'; }
+    
+    InlineText(string_view value) {
+        if (value.length() > N) {
+            throw length_error("Ledger field too long");
+        }
+        memcpy(text, value.data(), value.length());
+        length = (unsigned char)value.length();
+        text[length] = '\0';
+    }
+    
+    string_view view() const { return string_view(text, length); }
+    operator string_view() const { return view(); }
+    size_t size() const { return length; }
+};
+
+template <size_t N>
+ostream& operator<<(ostream& out, const InlineText<N>& value) {
+    return out << value.view();
+}
+
+// Single vote carried inside a block
+struct VoteEntry {
+    InlineText<MAX_VOTER_ID_LENGTH> voterID;
+    InlineText<MAX_CANDIDATE_NAME_LENGTH> candidate;
+    string rankedChoices;   // "A>B>C" for ranked ballots, empty for single-choice
+    time_t timestamp;
+    
+    VoteEntry(string_view vID, string_view cand, string_view ranked = string_view())
+        : voterID(vID), candidate(cand), rankedChoices(ranked) {
+        timestamp = time(NULL);
+    }
+    
+    // Hashes voterID, candidate, rankedChoices and the decimal timestamp,
+    // concatenated; data is scratch space for the concatenation
+    template <class Hasher>
+    void calculateHash(string& data, string& out) const {
+        char stamp[24];
+        int stampLength = snprintf(stamp, sizeof(stamp), "%lld", (long long)timestamp);
+        data.clear();
+        data.append(voterID.text, voterID.size());
+        data.append(candidate.text, candidate.size());
+        data += rankedChoices;
+        data.append(stamp, stampLength);
+        Hasher::hash(data, out);
+    }
+    
+    template <class Hasher>
+    string calculateHash() const {
+        string data, out;
+        calculateHash<Hasher>(data, out);
+        return out;
+    }
+};
+
+// Buffers reused across seals, so sealing a block allocates only for the
+// block itself (its vote array and three hash strings)
+struct BlockHashScratch {
+    string data;
+    vector<string> level;
+};
+
+// Blockchain block structure: a batch of votes sealed under one header hash
+struct VoteRecord {
+    int blockNumber;
+    vector<VoteEntry> votes;
+    string transactionsRoot;
+    time_t timestamp;
+    string hash;
+    string previousHash;
+    VoteRecord* next;
+    
+    VoteRecord() : blockNumber(0), timestamp(0), previousHash("0"), next(NULL) {}
+    
+    // Takes ownership of the pending votes and computes root and header hash
+    template <class Hasher>
+    void seal(int num, vector<VoteEntry>& pending, const string& prevHash, BlockHashScratch& scratch) {
+        blockNumber = num;
+        votes.swap(pending);
+        previousHash = prevHash;
+        timestamp = time(NULL);
+        calculateTransactionsRoot<Hasher>(scratch, transactionsRoot);
+        calculateHash<Hasher>(scratch.data, hash);
+    }
+    
+    // Merkle root over the vote hashes (last hash paired with itself on odd levels)
+    template <class Hasher>
+    void calculateTransactionsRoot(BlockHashScratch& scratch, string& root) const {
+        if (votes.empty()) {
+            root = "0";
+            return;
+        }
+        vector<string>& level = scratch.level;
+        if (level.size() < votes.size()) level.resize(votes.size());
+        for (size_t i = 0; i < votes.size(); i++) {
+            votes[i].calculateHash<Hasher>(scratch.data, level[i]);
+        }
+        size_t count = votes.size();
+        while (count > 1) {
+            size_t out = 0;
+            for (size_t i = 0; i < count; i += 2) {
+                const string& right = (i + 1 < count) ? level[i + 1] : level[i];
+                scratch.data.assign(level[i]);
+                scratch.data += right;
+                Hasher::hash(scratch.data, level[out++]);
+            }
+            count = out;
+        }
+        root = level[0];
+    }
+    
+    template <class Hasher>
+    string calculateTransactionsRoot() const {
+        BlockHashScratch scratch;
+        string root;
+        calculateTransactionsRoot<Hasher>(scratch, root);
+        return root;
+    }
+    
+    // Hashes number, root, vote count, timestamp and previous hash, concatenated
+    template <class Hasher>
+    void calculateHash(string& data, string& out) const {
+        char numbers[64];
+        data.clear();
+        data.append(numbers, snprintf(numbers, sizeof(numbers), "%d", blockNumber));
+        data += transactionsRoot;
+        data.append(numbers, snprintf(numbers, sizeof(numbers), "%zu%lld", votes.size(), (long long)timestamp));
+        data += previousHash;
+        Hasher::hash(data, out);
+    }
+    
+    template <class Hasher>
+    string calculateHash() const {
+        string data, out;
+        calculateHash<Hasher>(data, out);
+        return out;
+    }
+};
+
+// Block encoding shared by checkpoints and the ledger replica: number, time,
+// root, hash, previous hash, then each vote (ID, candidate, ranked choices, time)
+inline void putBlock(string& out, const VoteRecord& block) {
+    putVarint(out, block.blockNumber);
+    putSigned(out, (long long)block.timestamp);
+    putString(out, block.transactionsRoot);
+    putString(out, block.hash);
+    putString(out, block.previousHash);
+    putVarint(out, block.votes.size());
+    for (size_t i = 0; i < block.votes.size(); i++) {
+        const VoteEntry& vote = block.votes[i];
+        putString(out, vote.voterID);
+        putString(out, vote.candidate);
+        putString(out, vote.rankedChoices);
+        putSigned(out, (long long)vote.timestamp);
+    }
+}
+
+inline void getBlock(ByteReader& in, VoteRecord& block) {
+    block.blockNumber = (int)in.getVarint();
+    block.timestamp = (time_t)in.getSigned();
+    block.transactionsRoot = string(in.getString());
+    block.hash = string(in.getString());
+    block.previousHash = string(in.getString());
+    for (unsigned long long n = in.getVarint(); n > 0; n--) {
+        string_view voterID = in.getString();
+        string_view candidate = in.getString();
+        string_view ranked = in.getString();
+        block.votes.emplace_back(voterID, candidate, ranked);
+        block.votes.back().timestamp = (time_t)in.getSigned();
+    }
+}
+
+// Ledger storage policies: own the sealed blocks and keep their addresses stable
+
+// One allocation per block, linked through VoteRecord::next
+class LinkedBlockStorage {
 private:
     VoteRecord* head;
     VoteRecord* tail;
-    int recordCount;
+    int count;
+    
+public:
+    LinkedBlockStorage() : head(NULL), tail(NULL), count(0) {}
+    
+    VoteRecord* newBlock() {
+        VoteRecord* block = new VoteRecord();
+        if (head == NULL) {
+            head = tail = block;
+        } else {
+            tail->next = block;
+            tail = block;
+        }
+        count++;
+        return block;
+    }
+    
+    VoteRecord* first() const { return head; }
+    VoteRecord* last() const { return tail; }
+    VoteRecord* next(const VoteRecord* block) const { return block->next; }
+    int size() const { return count; }
+    
+    VoteRecord* at(int index) const {
+        if (index < 0 || index >= count) return NULL;
+        VoteRecord* current = head;
+        for (int i = 0; i < index; i++) {
+            current = current->next;
+        }
+        return current;
+    }
+    
+    ~LinkedBlockStorage() {
+        VoteRecord* current = head;
+        while (current != NULL) {
+            VoteRecord* toDelete = current;
+            current = current->next;
+            delete toDelete;
+        }
+    }
+};
+
+// Blocks allocated BLOCKS_PER_CHUNK at a time with O(1) indexed access;
+// VoteRecord::next is still maintained so blocks can be walked in order.
+// at() reads the chunk table, which newBlock() may reallocate, so it is
+// for the owning thread only. Other threads follow next (see ExportSnapshot).
+class ChunkedBlockStorage {
+private:
+    static const int BLOCKS_PER_CHUNK = 1024;
+    vector<VoteRecord*> chunks;
+    int count;
+    
+public:
+    ChunkedBlockStorage() : count(0) {}
+    
+    VoteRecord* newBlock() {
+        if (count % BLOCKS_PER_CHUNK == 0) {
+            chunks.push_back(new VoteRecord[BLOCKS_PER_CHUNK]);
+        }
+        VoteRecord* block = &chunks.back()[count % BLOCKS_PER_CHUNK];
+        if (count > 0) {
+            at(count - 1)->next = block;
+        }
+        count++;
+        return block;
+    }
+    
+    VoteRecord* at(int index) const {
+        if (index < 0 || index >= count) return NULL;
+        return &chunks[index / BLOCKS_PER_CHUNK][index % BLOCKS_PER_CHUNK];
+    }
+    
+    VoteRecord* first() const { return at(0); }
+    VoteRecord* last() const { return at(count - 1); }
+    VoteRecord* next(const VoteRecord* block) const { return block->next; }
+    int size() const { return count; }
+    
+    ~ChunkedBlockStorage() {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            delete[] chunks[i];
+        }
+    }
+};
+
+// Formats timestamps with strftime, reusing the text while the second is unchanged
+class TimestampFormatter {
+private:
+    const char* pattern;
+    time_t last;
+    char text[64];
+    
+public:
+    TimestampFormatter(const char* fmt) : pattern(fmt), last((time_t)-1) { text[0] = '\0'; }
+    
+    const char* format(time_t t) {
+        if (t != last) {
+            struct tm local;
+            localtime_r(&t, &local);
+            strftime(text, sizeof(text), pattern, &local);
+            last = t;
+        }
+        return text;
+    }
+};
+
+// ---------------- Shared-memory ledger replica ----------------
+// The voting process appends every sealed block to a memory-mapped file that
+// auditor processes map read-only and tail. A record is copied in first and
+// then published by a release store of committedBytes; readers acquire-load
+// the counter, so every byte below it is complete. Once the region is mapped
+// the writer takes no locks and makes no system calls.
+//
+// Layout: ReplicaHeader, then records of u32 length + putBlock encoding.
+
+enum ReplicaState { REPLICA_OPEN = 0, REPLICA_CLOSED = 1, REPLICA_FULL = 2 };
+
+struct ReplicaHeader {
+    char magic[8];                              // "EVREPL1\n"
+    char preset[16];                            // engine preset, selects the block hasher
+    unsigned long long capacity;                // record bytes after the header
+    atomic<unsigned long long> committedBytes;
+    atomic<unsigned long long> committedBlocks;
+    atomic<int> state;                          // ReplicaState
+};
+
+static_assert(atomic<unsigned long long>::is_always_lock_free && atomic<int>::is_always_lock_free,
+              "replica counters must be lock-free to be shared between processes");
+
+class LedgerReplica {
+private:
+    ReplicaHeader* header;
+    char* records;
+    size_t mappedBytes;
+    unsigned long long writeOffset;
+    unsigned long long blockCount;
+    string scratch;
+    
+public:
+    LedgerReplica() : header(NULL), records(NULL), mappedBytes(0), writeOffset(0), blockCount(0) {}
+    
+    // The file is built under a temporary name and renamed into place, so an
+    // auditor never maps a half-initialised header
+    bool open(const string& path, const char* preset, unsigned long long capacity) {
+        close();
+        string tempPath = path + ".tmp";
+        int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        size_t bytes = sizeof(ReplicaHeader) + capacity;
+        void* region = MAP_FAILED;
+        if (ftruncate(fd, bytes) == 0) {
+            region = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (region == MAP_FAILED) {
+            remove(tempPath.c_str());
+            return false;
+        }
+        header = new (region) ReplicaHeader();
+        memcpy(header->magic, "EVREPL1\n", 8);
+        snprintf(header->preset, sizeof(header->preset), "%s", preset);
+        header->capacity = capacity;
+        header->committedBytes.store(0);
+        header->committedBlocks.store(0);
+        header->state.store(REPLICA_OPEN);
+        records = (char*)region + sizeof(ReplicaHeader);
+        mappedBytes = bytes;
+        writeOffset = 0;
+        blockCount = 0;
+        scratch.reserve(1 << 16);
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            close();
+            remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+    bool isOpen() const { return header != NULL; }
+    
+    // False once the replica is closed or full; the block is then not published
+    bool publish(const VoteRecord& block) {
+        if (header == NULL || header->state.load(memory_order_relaxed) != REPLICA_OPEN) return false;
+        scratch.clear();
+        putFixed(scratch, 0, 4);
+        putBlock(scratch, block);
+        unsigned long long length = scratch.size() - 4;
+        for (int i = 0; i < 4; i++) {
+            scratch[i] = (char)((length >> (8 * i)) & 0xff);
+        }
+        if (writeOffset + scratch.size() > header->capacity) {
+            header->state.store(REPLICA_FULL, memory_order_release);
+            return false;
+        }
+        memcpy(records + writeOffset, scratch.data(), scratch.size());
+        writeOffset += scratch.size();
+        blockCount++;
+        header->committedBlocks.store(blockCount, memory_order_relaxed);
+        header->committedBytes.store(writeOffset, memory_order_release);
+        return true;
+    }
+    
+    // Tells auditors that no more blocks will follow
+    void close() {
+        if (header == NULL) return;
+        int expected = REPLICA_OPEN;
+        header->state.compare_exchange_strong(expected, REPLICA_CLOSED, memory_order_release);
+        munmap(header, mappedBytes);
+        header = NULL;
+        records = NULL;
+        mappedBytes = 0;
+    }
+    
+    unsigned long long getPublishedBlocks() const { return blockCount; }
+    unsigned long long getPublishedBytes() const { return writeOffset; }
+    
+    ~LedgerReplica() { close(); }
+};
+
+// Progress of an audit run in steps (BasicVoteLedger::continueAudit)
+struct ChainAudit {
+    const VoteRecord* next;     // next block to check, NULL = first block
+    int lastBlock;
+    int checkedBlocks;
+    size_t intervals;
+    size_t checkedIntervals;
+    string previousHash;
+    bool chainValid;
+    bool talliesValid;
+    
+    ChainAudit() : next(NULL), lastBlock(0), checkedBlocks(0), intervals(0), checkedIntervals(0),
+                   previousHash("0"), chainValid(true), talliesValid(true) {}
+};
+
+// Blockchain ledger: votes are batched into blocks of up to blockSize votes
+// or blockTimeMs milliseconds of votes, whichever fills first. Every
+// checkpointBlocks blocks the cumulative first-choice tallies are recorded,
+// so results at any block replay at most checkpointBlocks blocks.
+template <class Storage, class BlockHasher, class Log>
+class BasicVoteLedger {
+private:
+    // Tallies after block->blockNumber, indexed by ledger candidate ordinal
+    struct TallyCheckpoint {
+        const VoteRecord* block;
+        string blockHash;
+        vector<int> counts;
+    };
+    
+    Storage blocks;
+    int voteCount;
+    int blockSize;
+    int blockTimeMs;
+    int checkpointBlocks;
+    vector<VoteEntry> pending;
+    steady_clock::time_point pendingSince;
+    vector<string> candidateNames;
+    vector<int> runningCounts;
+    vector<TallyCheckpoint> checkpoints;
+    LedgerReplica* replica;
+    BlockHashScratch sealScratch;
+    
+    void publish(const VoteRecord* block) {
+        if (replica != NULL && !replica->publish(*block)) {
+            Log::write(LOG_WARN, "[WARNING] Ledger replica is full; auditors stop before Block #{}",
+                       block->blockNumber);
+            replica = NULL;
+        }
+    }
+    
+    void sealBlock() {
+        if (pending.empty()) return;
+        static const string genesisHash = "0";
+        VoteRecord* tail = blocks.last();
+        const string& prevHash = (tail != NULL) ? tail->hash : genesisHash;
+        VoteRecord* newRecord = blocks.newBlock();
+        newRecord->seal<BlockHasher>(blocks.size(), pending, prevHash, sealScratch);
+        pending.clear();
+        pending.reserve(blockSize);
+        countBlock(newRecord);
+        publish(newRecord);
+    }
+    
+    int findCandidate(string_view name) const {
+        for (size_t i = 0; i < candidateNames.size(); i++) {
+            if (candidateNames[i] == name) return (int)i;
+        }
+        return -1;
+    }
+    
+    // Add a sealed block to the running tallies; checkpoint on interval boundaries
+    void countBlock(const VoteRecord* block) {
+        for (size_t i = 0; i < block->votes.size(); i++) {
+            int ordinal = findCandidate(block->votes[i].candidate);
+            if (ordinal < 0) {
+                candidateNames.push_back(string(block->votes[i].candidate.view()));
+                runningCounts.push_back(0);
+                ordinal = (int)candidateNames.size() - 1;
+            }
+            runningCounts[ordinal]++;
+        }
+        if (block->blockNumber % checkpointBlocks == 0) {
+            TallyCheckpoint checkpoint;
+            checkpoint.block = block;
+            checkpoint.blockHash = block->hash;
+            checkpoint.counts = runningCounts;
+            checkpoints.push_back(checkpoint);
+        }
+    }
+    
+    // Replay blocks after `from` (NULL = genesis) up to block #last into counts;
+    // false if a vote names a candidate the ledger has not seen
+    bool replay(const VoteRecord* from, int last, vector<int>& counts, int& replayed) const {
+        counts.resize(candidateNames.size(), 0);
+        replayed = 0;
+        const VoteRecord* block = (from == NULL) ? blocks.first() : blocks.next(from);
+        for (; block != NULL && block->blockNumber <= last; block = blocks.next(block)) {
+            for (size_t i = 0; i < block->votes.size(); i++) {
+                int ordinal = findCandidate(block->votes[i].candidate);
+                if (ordinal < 0) return false;
+                counts[ordinal]++;
+            }
+            replayed++;
+        }
+        return true;
+    }
+    
+    bool blockTimeElapsed() const {
+        if (blockTimeMs <= 0 || pending.empty()) return false;
+        return duration_cast<milliseconds>(steady_clock::now() - pendingSince).count() >= blockTimeMs;
+    }
     
 public:
-    VoteLedger() : head(NULL), tail(NULL), recordCount(0) {}
+    BasicVoteLedger(int votesPerBlock = 64, int blockTimeMillis = 500, int checkpointInterval = 64)
+        : voteCount(0), blockSize(votesPerBlock < 1 ? 1 : votesPerBlock), blockTimeMs(blockTimeMillis),
+          checkpointBlocks(checkpointInterval < 1 ? 1 : checkpointInterval), replica(NULL) {
+        pending.reserve(blockSize);
+    }
     
-    void addVote(string voterID, string candidate) {
+    void addVote(string_view voterID, string_view candidate, string_view rankedChoices = string_view()) {
         auto start = high_resolution_clock::now();
         try {
-            string prevHash = (tail != NULL) ? tail->hash : "0";
-            VoteRecord* newRecord = new VoteRecord(voterID, candidate, prevHash);
-            if (head == NULL) {
-                head = tail = newRecord;
-            } else {
-                tail->next = newRecord;
-                tail = newRecord;
+            if (blockTimeElapsed()) {
+                sealBlock();
+            }
+            if (pending.empty()) {
+                pendingSince = steady_clock::now();
+            }
+            pending.emplace_back(voterID, candidate, rankedChoices);
+            voteCount++;
+            int slot = (int)pending.size();
+            if (slot >= blockSize) {
+                sealBlock();
             }
-            recordCount++;
             auto end = high_resolution_clock::now();
             auto duration = duration_cast<microseconds>(end - start);
-            cout << "[BLOCKCHAIN] Vote recorded in Block #" << recordCount << "\n";
-            cout << "             [TIME] Blockchain Insert: " << duration.count() << " microseconds\n";
-            cout << "             Time Complexity: O(1) - append to end\n";
+            Log::write(LOG_INFO, "[BLOCKCHAIN] Vote recorded in Block #{} (slot {}/{})",
+                       blocks.size() + (slot < blockSize ? 1 : 0), slot, blockSize);
+            Log::write(LOG_DEBUG, "             [TIME] Blockchain Insert: {} microseconds\n"
+                       "             Time Complexity: O(1) amortized - block sealed every {} votes",
+                       (long long)duration.count(), blockSize);
         } catch (const exception& e) {
-            cout << "[ERROR] Blockchain error: " << e.what() << "\n";
+            Log::write(LOG_ERROR, "[ERROR] Blockchain error: {}", e.what());
         }
     }
     
+    // Seal any pending votes into a block now
+    void commitPending() { sealBlock(); }
+    
+    // Seal the pending votes once the oldest has waited blockTimeMs. Callers
+    // poll this between requests, so a quiet ledger still seals on time
+    bool sealIfDue() {
+        if (!blockTimeElapsed()) return false;
+        sealBlock();
+        return true;
+    }
+    
+    // Milliseconds until sealIfDue() has work; -1 when nothing is pending
+    int millisUntilSeal() const {
+        if (blockTimeMs <= 0 || pending.empty()) return -1;
+        long long waited = duration_cast<milliseconds>(steady_clock::now() - pendingSince).count();
+        return (int)max(blockTimeMs - waited, 0LL);
+    }
+    
     void displayLedger() {
+        commitPending();
         cout << "\n+========================================+\n";
         cout << "|       BLOCKCHAIN VOTE LEDGER           |\n";
         cout << "+========================================+\n";
-        VoteRecord* current = head;
-        int blockNum = 1;
-        while (current != NULL) {
-            cout << "\n+-- Block #" << blockNum << " -------------------------\n";
-            cout << "| Voter: " << current->voterID << "\n";
-            cout << "| Candidate: " << current->candidate << "\n";
-            char* timeStr = ctime(&current->timestamp);
-            cout << "| Time: " << timeStr;
+        TimestampFormatter blockTime("%a %b %e %H:%M:%S %Y");
+        for (VoteRecord* current = blocks.first(); current != NULL; current = blocks.next(current)) {
+            cout << "\n+-- Block #" << current->blockNumber << " -------------------------\n";
+            cout << "| Time: " << blockTime.format(current->timestamp) << "\n";
+            cout << "| Votes: " << current->votes.size() << "\n";
+            for (size_t i = 0; i < current->votes.size(); i++) {
+                const VoteEntry& vote = current->votes[i];
+                cout << "|   " << setw(10) << left << vote.voterID << " -> " << vote.candidate;
+                if (!vote.rankedChoices.empty()) cout << " (" << vote.rankedChoices << ")";
+                cout << "\n";
+            }
+            cout << "| Tx Root: " << current->transactionsRoot << "\n";
             cout << "| Hash: " << current->hash << "\n";
             cout << "| Previous: " << current->previousHash << "\n";
             cout << "+--------------------------------------\n";
-            current = current->next;
-            blockNum++;
         }
-        cout << "\nTotal blocks: " << recordCount << "\n";
-        cout << "Traversal Time Complexity: O(n) where n = " << recordCount << "\n\n";
+        cout << "\nTotal blocks: " << blocks.size() << " | Total votes: " << voteCount << "\n";
+        cout << "Traversal Time Complexity: O(n) where n = " << voteCount << "\n\n";
     }
     
     bool verifyChain() {
         auto start = high_resolution_clock::now();
-        if (head == NULL) return true;
-        VoteRecord* current = head;
-        int blockNum = 1;
-        while (current != NULL) {
-            string calculatedHash = current->calculateHash();
-            if (calculatedHash != current->hash) {
-                cout << "[ALERT] Block #" << blockNum << " has been tampered!\n";
+        commitPending();
+        for (VoteRecord* current = blocks.first(); current != NULL; current = blocks.next(current)) {
+            if (current->calculateTransactionsRoot<BlockHasher>() != current->transactionsRoot) {
+                Log::write(LOG_ALERT, "[ALERT] Votes in Block #{} have been tampered!", current->blockNumber);
+                return false;
+            }
+            if (current->calculateHash<BlockHasher>() != current->hash) {
+                Log::write(LOG_ALERT, "[ALERT] Block #{} has been tampered!", current->blockNumber);
                 return false;
             }
-            if (current->next != NULL) {
-                if (current->hash != current->next->previousHash) {
-                    cout << "[ALERT] Chain broken between Block #" << blockNum
-                         << " and #" << (blockNum + 1) << "!\n";
+            VoteRecord* next = blocks.next(current);
+            if (next != NULL) {
+                if (current->hash != next->previousHash) {
+                    Log::write(LOG_ALERT, "[ALERT] Chain broken between Block #{} and #{}!",
+                               current->blockNumber, next->blockNumber);
                     return false;
                 }
             }
-            current = current->next;
-            blockNum++;
         }
         auto end = high_resolution_clock::now();
         auto duration = duration_cast<microseconds>(end - start);
-        cout << "[TIME] Blockchain Verification: " << duration.count() << " microseconds\n";
-        cout << "       Time Complexity: O(n) where n = " << recordCount << "\n";
+        Log::write(LOG_DEBUG, "[TIME] Blockchain Verification: {} microseconds\n"
+                   "       Time Complexity: O(n) where n = {} votes in {} blocks",
+                   (long long)duration.count(), voteCount, blocks.size());
         return true;
     }
     
     void auditBlockchain() {
+        commitPending();
+        bool chainValid = verifyChain();
+        bool talliesValid = verifyTallyCheckpoints();
+        displayAuditReport(chainValid, talliesValid);
+    }
+    
+    // Audit in bounded steps: beginAudit fixes the blocks to check, then each
+    // continueAudit call checks up to maxBlocks blocks (or tally intervals)
+    // and returns true once the audit is complete. Sealed blocks never
+    // change, so votes may be added between steps.
+    void beginAudit(ChainAudit& audit) {
+        commitPending();
+        audit = ChainAudit();
+        audit.lastBlock = blocks.size();
+        audit.intervals = checkpoints.size() + 1;
+    }
+    
+    bool continueAudit(ChainAudit& audit, int maxBlocks) {
+        for (int step = 0; step < maxBlocks; step++) {
+            if (audit.checkedBlocks < audit.lastBlock) {
+                const VoteRecord* current = (audit.next == NULL) ? blocks.first() : audit.next;
+                if (current->calculateTransactionsRoot<BlockHasher>() != current->transactionsRoot) {
+                    Log::write(LOG_ALERT, "[ALERT] Votes in Block #{} have been tampered!", current->blockNumber);
+                    audit.chainValid = false;
+                } else if (current->calculateHash<BlockHasher>() != current->hash) {
+                    Log::write(LOG_ALERT, "[ALERT] Block #{} has been tampered!", current->blockNumber);
+                    audit.chainValid = false;
+                } else if (current->previousHash != audit.previousHash) {
+                    Log::write(LOG_ALERT, "[ALERT] Chain broken between Block #{} and #{}!",
+                               current->blockNumber - 1, current->blockNumber);
+                    audit.chainValid = false;
+                }
+                audit.previousHash = current->hash;
+                audit.next = blocks.next(current);
+                audit.checkedBlocks++;
+            } else if (audit.checkedIntervals < audit.intervals) {
+                if (!verifyTallyInterval(audit.checkedIntervals)) {
+                    reportTallyMismatch(audit.checkedIntervals);
+                    audit.talliesValid = false;
+                }
+                audit.checkedIntervals++;
+            } else {
+                return true;
+            }
+        }
+        return audit.checkedBlocks == audit.lastBlock && audit.checkedIntervals == audit.intervals;
+    }
+    
+    void displayAuditReport(bool chainValid, bool talliesValid) {
+        bool valid = chainValid && talliesValid;
+        Log::flush();
         cout << "\n+========================================+\n";
         cout << "|     BLOCKCHAIN SECURITY AUDIT          |\n";
         cout << "+========================================+\n";
-        cout << "  Total Blocks: " << recordCount << "\n";
+        cout << "  Total Blocks: " << blocks.size() << "\n";
+        cout << "  Total Votes: " << voteCount << "\n";
+        cout << "  Block Size: up to " << blockSize << " votes / " << blockTimeMs << " ms\n";
+        cout << "  Tally Checkpoints: " << checkpoints.size() << " (every " << checkpointBlocks
+             << " blocks, " << (talliesValid ? "consistent" : "MISMATCH") << ")\n";
         cout << "  Chain Status: ";
-        if (verifyChain()) {
+        if (valid) {
             cout << "VALID (No tampering detected)\n";
             cout << "  Security: HIGH\n";
         } else {
@@ -530,18 +2050,146 @@ public:
         cout << "\n";
     }
     
-    int getTotalVotes() const { return recordCount; }
+    int getTotalVotes() const { return voteCount; }
+    int getBlockCount() const { return blocks.size(); }
+    int getBlockSize() const { return blockSize; }
     
-    ~VoteLedger() {
-        VoteRecord* current = head;
-        while (current != NULL) {
-            VoteRecord* toDelete = current;
-            current = current->next;
-            delete toDelete;
+    // Appends a block read back from a checkpoint, keeping its stored hashes
+    void restoreBlock(VoteRecord& source) {
+        sealBlock();
+        VoteRecord* block = blocks.newBlock();
+        block->blockNumber = source.blockNumber;
+        block->votes.swap(source.votes);
+        block->transactionsRoot = source.transactionsRoot;
+        block->timestamp = source.timestamp;
+        block->hash = source.hash;
+        block->previousHash = source.previousHash;
+        voteCount += (int)block->votes.size();
+        countBlock(block);
+        publish(block);
+    }
+    
+    // Publish every sealed block to replica from now on, starting with the
+    // ones already sealed; NULL detaches
+    void attachReplica(LedgerReplica* target) {
+        replica = target;
+        for (const VoteRecord* block = blocks.first(); replica != NULL && block != NULL; block = blocks.next(block)) {
+            publish(block);
         }
     }
-};
-
+    
+    // First-choice results as of block #blockNum (0 = before any block),
+    // starting from the nearest checkpoint at or before it
+    bool talliesAtBlock(int blockNum, vector<pair<string, int> >& out, int* replayedBlocks = NULL) const {
+        if (blockNum < 0 || blockNum > blocks.size()) return false;
+        int index = blockNum / checkpointBlocks - 1;
+        vector<int> counts;
+        const VoteRecord* from = NULL;
+        if (index >= 0) {
+            counts = checkpoints[index].counts;
+            from = checkpoints[index].block;
+        }
+        int replayed = 0;
+        if (!replay(from, blockNum, counts, replayed)) return false;
+        if (replayedBlocks != NULL) *replayedBlocks = replayed;
+        for (size_t i = 0; i < candidateNames.size(); i++) {
+            out.push_back(make_pair(candidateNames[i], counts[i]));
+        }
+        return true;
+    }
+    
+    // Number of the last block sealed at or before t, 0 if none
+    int blockAtTime(time_t t) const {
+        size_t low = 0;
+        size_t high = checkpoints.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (checkpoints[mid].block->timestamp <= t) low = mid + 1;
+            else high = mid;
+        }
+        const VoteRecord* block = (low == 0) ? blocks.first() : checkpoints[low - 1].block;
+        int found = (low == 0) ? 0 : block->blockNumber;
+        for (; block != NULL && block->timestamp <= t; block = blocks.next(block)) {
+            found = block->blockNumber;
+        }
+        return found;
+    }
+    
+    // Audit each checkpoint interval on its own thread: replaying the
+    // interval from the previous checkpoint must give the next checkpoint's
+    // tallies (or the current tallies for the open interval)
+    bool verifyTallyCheckpoints(int threads = defaultThreadCount()) const {
+        auto start = high_resolution_clock::now();
+        size_t intervals = checkpoints.size() + 1;
+        atomic<long long> firstBad(-1);
+        parallelFor(intervals, threads, [&](int, size_t begin, size_t end) {
+            for (size_t i = begin; i < end && firstBad.load(memory_order_relaxed) < 0; i++) {
+                if (!verifyTallyInterval(i)) {
+                    long long none = -1;
+                    firstBad.compare_exchange_strong(none, (long long)i);
+                }
+            }
+        });
+        auto end = high_resolution_clock::now();
+        long long bad = firstBad.load();
+        if (bad >= 0) {
+            reportTallyMismatch((size_t)bad);
+            return false;
+        }
+        Log::write(LOG_DEBUG, "[TIME] Tally Checkpoint Audit: {} microseconds ({} intervals)",
+                   (long long)duration_cast<microseconds>(end - start).count(), intervals);
+        return true;
+    }
+    
+    // Interval i runs from checkpoint i-1 (or genesis) to checkpoint i, or to
+    // the newest block for i == getCheckpointCount()
+    bool verifyTallyInterval(size_t i) const {
+        vector<int> counts;
+        const VoteRecord* from = NULL;
+        if (i > 0) {
+            counts = checkpoints[i - 1].counts;
+            from = checkpoints[i - 1].block;
+        }
+        bool closed = i < checkpoints.size();
+        int last = closed ? checkpoints[i].block->blockNumber : blocks.size();
+        vector<int> expected = closed ? checkpoints[i].counts : runningCounts;
+        int replayed = 0;
+        bool ok = replay(from, last, counts, replayed);
+        expected.resize(counts.size(), 0);
+        ok = ok && counts == expected;
+        if (closed) ok = ok && checkpoints[i].block->hash == checkpoints[i].blockHash;
+        return ok;
+    }
+    
+    void reportTallyMismatch(size_t i) const {
+        Log::write(LOG_ALERT, "[ALERT] Tallies between blocks #{} and #{} do not match their checkpoint!",
+                   i == 0 ? 1 : checkpoints[i - 1].block->blockNumber + 1,
+                   i < checkpoints.size() ? checkpoints[i].block->blockNumber : blocks.size());
+    }
+    
+    int getCheckpointCount() const { return (int)checkpoints.size(); }
+    int getCheckpointInterval() const { return checkpointBlocks; }
+    
+    // Sealed blocks never change, so [first, first + getBlockCount()) stays
+    // readable from another thread while new blocks are appended
+    const VoteRecord* getFirstBlock() const { return blocks.first(); }
+    const VoteRecord* getLastBlock() const { return blocks.last(); }
+    
+    string getHeadHash() const {
+        VoteRecord* tail = blocks.last();
+        return (tail != NULL) ? tail->hash : "0";
+    }
+    
+    // Hash of block #blockNum (1-based), empty if out of range
+    string getHashAt(int blockNum) const {
+        if (blockNum == 0) return "0";
+        VoteRecord* block = blocks.at(blockNum - 1);
+        return (block != NULL) ? block->hash : "";
+    }
+};
+
+typedef BasicVoteLedger<LinkedBlockStorage, Djb2BlockHasher, AsyncLogSink> VoteLedger;
+
 // BST Node for candidates
 struct CandidateNode {
     string name;
@@ -552,11 +2200,12 @@ struct CandidateNode {
 };
 
 // Binary Search Tree for candidates
-class CandidateBST {
+template <class Log>
+class BasicCandidateBST {
 private:
     CandidateNode* root;
     
-    CandidateNode* insert(CandidateNode* node, string name) {
+    CandidateNode* insert(CandidateNode* node, const string& name) {
         if (node == NULL) {
             return new CandidateNode(name);
         }
@@ -568,7 +2217,7 @@ private:
         return node;
     }
     
-    CandidateNode* search(CandidateNode* node, string name) {
+    CandidateNode* search(CandidateNode* node, string_view name) {
         if (node == NULL || node->name == name) {
             return node;
         }
@@ -599,6 +2248,14 @@ private:
         return 1 + max(leftHeight, rightHeight);
     }
     
+    void collect(CandidateNode* node, vector<pair<string, int> >& out) {
+        if (node != NULL) {
+            collect(node->left, out);
+            out.push_back(make_pair(node->name, node->voteCount));
+            collect(node->right, out);
+        }
+    }
+    
     void destroy(CandidateNode* node) {
         if (node != NULL) {
             destroy(node->left);
@@ -607,283 +2264,4252 @@ private:
         }
     }
     
-    void displayPercent(CandidateNode* node, int total) {
-        if (node != NULL) {
-            displayPercent(node->left, total);
-            double percent = (node->voteCount * 100.0) / total;
-            cout << "  " << setw(20) << left << node->name
-                 << ": " << setw(5) << node->voteCount << " votes ("
-                 << fixed << setprecision(1) << percent << "%)\n";
-            displayPercent(node->right, total);
+    void displayPercent(CandidateNode* node, int total) {
+        if (node != NULL) {
+            displayPercent(node->left, total);
+            double percent = (node->voteCount * 100.0) / total;
+            cout << "  " << setw(20) << left << node->name
+                 << ": " << setw(5) << node->voteCount << " votes ("
+                 << fixed << setprecision(1) << percent << "%)\n";
+            displayPercent(node->right, total);
+        }
+    }
+    
+public:
+    BasicCandidateBST() : root(NULL) {}
+    
+    void addCandidate(const string& name) {
+        if (name.length() > MAX_CANDIDATE_NAME_LENGTH) {
+            Log::write(LOG_ERROR, "[ERROR] Candidate name too long: {}", name);
+            return;
+        }
+        root = insert(root, name);
+        Log::write(LOG_INFO, "[SUCCESS] Candidate added: {}", name);
+    }
+    
+    bool addVote(string_view name) {
+        auto start = high_resolution_clock::now();
+        CandidateNode* candidate = search(root, name);
+        auto end = high_resolution_clock::now();
+        auto duration = duration_cast<microseconds>(end - start);
+        if (candidate == NULL) {
+            return false;
+        }
+        candidate->voteCount++;
+        if (Log::enabled(LOG_DEBUG)) {
+            int height = getHeight(root);
+            Log::write(LOG_DEBUG, "          [TIME] BST Search: {} microseconds\n"
+                       "          Tree Height: {} | Time Complexity: O(log n) avg, O({}) this case",
+                       (long long)duration.count(), height, height);
+        }
+        return true;
+    }
+    
+    void displayResults() {
+        cout << "\n+========================================+\n";
+        cout << "|       ELECTION RESULTS                 |\n";
+        cout << "+========================================+\n";
+        inorder(root);
+        cout << "\n  Total votes: " << getTotalVotes(root) << "\n";
+        cout << "  BST Height: " << getHeight(root) << "\n";
+        cout << "  Inorder Traversal: O(n) where n = number of candidates\n\n";
+    }
+    
+    void displayPercentages() {
+        int total = getTotalVotes(root);
+        if (total == 0) {
+            cout << "No votes cast yet.\n";
+            return;
+        }
+        cout << "\n+========================================+\n";
+        cout << "|       VOTE PERCENTAGES                 |\n";
+        cout << "+========================================+\n";
+        displayPercent(root, total);
+        cout << "\n";
+    }
+    
+    bool candidateExists(string_view name) {
+        return search(root, name) != NULL;
+    }
+    
+    // Used when tallies are rebuilt from the ledger
+    bool setVoteCount(string_view name, int count) {
+        CandidateNode* candidate = search(root, name);
+        if (candidate == NULL) return false;
+        candidate->voteCount = count;
+        return true;
+    }
+    
+    // Candidates with their vote counts, in name order
+    void collectResults(vector<pair<string, int> >& out) {
+        collect(root, out);
+    }
+    
+    ~BasicCandidateBST() {
+        destroy(root);
+    }
+};
+
+typedef BasicCandidateBST<AsyncLogSink> CandidateBST;
+
+// Flat tally engine: candidates kept sorted in one contiguous array,
+// found by binary search without pointer chasing
+template <class Log>
+class BasicCandidateArray {
+private:
+    vector<CandidateNode> nodes;
+    
+    int find(string_view name) const {
+        size_t low = 0;
+        size_t high = nodes.size();
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            if (nodes[mid].name < name) low = mid + 1;
+            else high = mid;
+        }
+        return (low < nodes.size() && nodes[low].name == name) ? (int)low : -1;
+    }
+    
+    int getTotalVotes() const {
+        int total = 0;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            total += nodes[i].voteCount;
+        }
+        return total;
+    }
+    
+public:
+    void addCandidate(const string& name) {
+        if (name.length() > MAX_CANDIDATE_NAME_LENGTH) {
+            Log::write(LOG_ERROR, "[ERROR] Candidate name too long: {}", name);
+            return;
+        }
+        if (find(name) >= 0) return;
+        size_t pos = 0;
+        while (pos < nodes.size() && nodes[pos].name < name) pos++;
+        nodes.insert(nodes.begin() + pos, CandidateNode(name));
+        Log::write(LOG_INFO, "[SUCCESS] Candidate added: {}", name);
+    }
+    
+    bool addVote(string_view name) {
+        int index = find(name);
+        if (index < 0) {
+            return false;
+        }
+        nodes[index].voteCount++;
+        return true;
+    }
+    
+    void displayResults() {
+        cout << "\n+========================================+\n";
+        cout << "|       ELECTION RESULTS                 |\n";
+        cout << "+========================================+\n";
+        for (size_t i = 0; i < nodes.size(); i++) {
+            cout << "  " << setw(20) << left << nodes[i].name
+                 << ": " << nodes[i].voteCount << " votes\n";
+        }
+        cout << "\n  Total votes: " << getTotalVotes() << "\n";
+        cout << "  Sorted Array: " << nodes.size() << " candidates\n";
+        cout << "  Traversal: O(n) where n = number of candidates\n\n";
+    }
+    
+    void displayPercentages() {
+        int total = getTotalVotes();
+        if (total == 0) {
+            cout << "No votes cast yet.\n";
+            return;
+        }
+        cout << "\n+========================================+\n";
+        cout << "|       VOTE PERCENTAGES                 |\n";
+        cout << "+========================================+\n";
+        for (size_t i = 0; i < nodes.size(); i++) {
+            double percent = (nodes[i].voteCount * 100.0) / total;
+            cout << "  " << setw(20) << left << nodes[i].name
+                 << ": " << setw(5) << nodes[i].voteCount << " votes ("
+                 << fixed << setprecision(1) << percent << "%)\n";
+        }
+        cout << "\n";
+    }
+    
+    bool candidateExists(string_view name) {
+        return find(name) >= 0;
+    }
+    
+    // Used when tallies are rebuilt from the ledger
+    bool setVoteCount(string_view name, int count) {
+        int index = find(name);
+        if (index < 0) return false;
+        nodes[index].voteCount = count;
+        return true;
+    }
+    
+    // Candidates with their vote counts, in name order
+    void collectResults(vector<pair<string, int> >& out) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            out.push_back(make_pair(nodes[i].name, nodes[i].voteCount));
+        }
+    }
+};
+
+// Instant-runoff tally. Ballots are stored column-wise as candidate ordinals:
+// rankColumns[r][b] is ballot b's (r+1)-th preference, NO_CHOICE when shorter.
+// A single-choice ballot is a one-column ballot, so plurality is round 1.
+// Counting is plain scalar code, not SIMD: one-byte ordinals keep the
+// columns compact, and parallelHistogram's interleaved sub-histograms avoid
+// back-to-back increments of the same counter.
+class InstantRunoffTally {
+public:
+    static const unsigned char NO_CHOICE = 255;
+    static const unsigned char EXHAUSTED = 254;
+    static const int MAX_CANDIDATES = 254;
+    
+    struct Round {
+        vector<long long> counts;   // per candidate ordinal, 0 once eliminated
+        long long exhausted;
+        int eliminated;             // -1 in the final round
+        long long transferred;
+    };
+    
+    struct Result {
+        vector<Round> rounds;
+        int winner;
+        double seconds;
+    };
+    
+private:
+    vector<string> candidateNames;
+    vector<vector<unsigned char> > rankColumns;
+    size_t ballotCount;
+    int threads;
+    
+    // New rank column, padded for earlier ballots and reserved like column 0
+    void addColumn() {
+        rankColumns.push_back(vector<unsigned char>());
+        vector<unsigned char>& column = rankColumns.back();
+        column.reserve(rankColumns.size() > 1 ? rankColumns[0].capacity() : ballotCount);
+        column.assign(ballotCount, NO_CHOICE);
+    }
+    
+public:
+    InstantRunoffTally() : ballotCount(0), threads(defaultThreadCount()) {}
+    
+    int addCandidate(const string& name) {
+        int existing = ordinalOf(name);
+        if (existing >= 0) return existing;
+        if ((int)candidateNames.size() >= MAX_CANDIDATES) return -1;
+        if (name.length() > MAX_CANDIDATE_NAME_LENGTH) return -1;
+        candidateNames.push_back(name);
+        return (int)candidateNames.size() - 1;
+    }
+    
+    int ordinalOf(string_view name) const {
+        for (size_t i = 0; i < candidateNames.size(); i++) {
+            if (candidateNames[i] == name) return (int)i;
+        }
+        return -1;
+    }
+    
+    void reserve(size_t ballots, int ranks) {
+        while ((int)rankColumns.size() < ranks) {
+            addColumn();
+        }
+        for (size_t r = 0; r < rankColumns.size(); r++) {
+            rankColumns[r].reserve(ballots);
+        }
+    }
+    
+    // Ordinals in preference order; caller guarantees they are valid and distinct
+    void addBallot(const unsigned char* ordinals, int length) {
+        while ((int)rankColumns.size() < length) {
+            addColumn();
+        }
+        for (size_t r = 0; r < rankColumns.size(); r++) {
+            rankColumns[r].push_back((int)r < length ? ordinals[r] : NO_CHOICE);
+        }
+        ballotCount++;
+    }
+    
+    // First-choice votes per candidate ordinal (plurality tallies)
+    vector<long long> firstChoiceCounts() const {
+        vector<long long> counts(candidateNames.size(), 0);
+        if (ballotCount == 0 || rankColumns.empty()) return counts;
+        vector<long long> histogram = parallelHistogram(&rankColumns[0][0], ballotCount, threads);
+        for (size_t c = 0; c < counts.size(); c++) counts[c] = histogram[c];
+        return counts;
+    }
+    
+    void clearBallots() {
+        rankColumns.clear();
+        ballotCount = 0;
+    }
+    
+    size_t getBallotCount() const { return ballotCount; }
+    int getCandidateCount() const { return (int)candidateNames.size(); }
+    const string& candidateName(int ordinal) const { return candidateNames[ordinal]; }
+    void setThreads(int count) { threads = count < 1 ? 1 : count; }
+    
+    Result tabulate() const {
+        auto start = high_resolution_clock::now();
+        Result result;
+        result.winner = -1;
+        const int candidateCount = (int)candidateNames.size();
+        const int rankCount = (int)rankColumns.size();
+        if (candidateCount == 0 || ballotCount == 0 || rankCount == 0) {
+            result.seconds = 0;
+            return result;
+        }
+        
+        // Current preference of every ballot and how far down its ranking it is
+        vector<unsigned char> top(rankColumns[0]);
+        vector<unsigned char> cursor(ballotCount, 0);
+        vector<char> eliminated(candidateCount, 0);
+        vector<vector<long long> > partial(threads, vector<long long>(candidateCount + 1, 0));
+        
+        // Round 1: first-preference histogram
+        vector<long long> firsts = parallelHistogram(&top[0], ballotCount, threads);
+        Round round;
+        round.counts.assign(firsts.begin(), firsts.begin() + candidateCount);
+        round.exhausted = firsts[NO_CHOICE];
+        round.eliminated = -1;
+        round.transferred = 0;
+        
+        int remaining = candidateCount;
+        while (true) {
+            long long continuing = (long long)ballotCount - round.exhausted;
+            // Ties for last place eliminate the lowest ordinal
+            int leader = -1;
+            int lowest = -1;
+            for (int c = 0; c < candidateCount; c++) {
+                if (eliminated[c]) continue;
+                if (leader < 0 || round.counts[c] > round.counts[leader]) leader = c;
+                if (lowest < 0 || round.counts[c] < round.counts[lowest]) lowest = c;
+            }
+            if (remaining <= 1 || round.counts[leader] * 2 > continuing) {
+                result.winner = leader;
+                result.rounds.push_back(round);
+                break;
+            }
+            round.eliminated = lowest;
+            result.rounds.push_back(round);
+            
+            // Only ballots currently sitting with the eliminated candidate move
+            eliminated[lowest] = 1;
+            remaining--;
+            const unsigned char loser = (unsigned char)lowest;
+            parallelFor(ballotCount, threads, [&](int t, size_t begin, size_t end) {
+                vector<long long>& delta = partial[t];
+                fill(delta.begin(), delta.end(), 0);
+                unsigned char* current = &top[0];
+                for (size_t b = begin; b < end; b++) {
+                    if (current[b] != loser) continue;
+                    int r = cursor[b] + 1;
+                    unsigned char next = EXHAUSTED;
+                    for (; r < rankCount; r++) {
+                        unsigned char choice = rankColumns[r][b];
+                        if (choice == NO_CHOICE) break;
+                        if (!eliminated[choice]) {
+                            next = choice;
+                            break;
+                        }
+                    }
+                    cursor[b] = (unsigned char)min(r, rankCount - 1);
+                    current[b] = next;
+                    delta[next == EXHAUSTED ? candidateCount : next]++;
+                }
+            });
+            Round nextRound;
+            nextRound.counts = round.counts;
+            nextRound.counts[lowest] = 0;
+            nextRound.exhausted = round.exhausted;
+            nextRound.eliminated = -1;
+            nextRound.transferred = 0;
+            for (int t = 0; t < threads; t++) {
+                for (int c = 0; c < candidateCount; c++) {
+                    nextRound.counts[c] += partial[t][c];
+                    nextRound.transferred += partial[t][c];
+                }
+                nextRound.exhausted += partial[t][candidateCount];
+            }
+            round = nextRound;
+        }
+        auto end = high_resolution_clock::now();
+        result.seconds = duration_cast<microseconds>(end - start).count() / 1e6;
+        return result;
+    }
+    
+    void displayRounds(const Result& result) const {
+        cout << "\n+========================================+\n";
+        cout << "|    RANKED-CHOICE (INSTANT RUNOFF)      |\n";
+        cout << "+========================================+\n";
+        if (result.rounds.empty()) {
+            cout << "No ballots cast yet.\n\n";
+            return;
+        }
+        for (size_t r = 0; r < result.rounds.size(); r++) {
+            const Round& round = result.rounds[r];
+            long long continuing = (long long)ballotCount - round.exhausted;
+            cout << "\n  Round " << (r + 1);
+            if (r > 0) cout << " (" << round.transferred << " transferred)";
+            cout << "\n";
+            for (int c = 0; c < (int)candidateNames.size(); c++) {
+                bool out = false;
+                for (size_t p = 0; p < r; p++) {
+                    if (result.rounds[p].eliminated == c) out = true;
+                }
+                if (out) continue;
+                double percent = continuing > 0 ? round.counts[c] * 100.0 / continuing : 0.0;
+                cout << "    " << setw(20) << left << candidateNames[c]
+                     << ": " << setw(9) << round.counts[c] << " ("
+                     << fixed << setprecision(1) << percent << "%)\n";
+            }
+            cout << "    Exhausted: " << round.exhausted << "\n";
+            if (round.eliminated >= 0) {
+                cout << "    Eliminated: " << candidateNames[round.eliminated] << "\n";
+            }
+        }
+        if (result.winner >= 0) {
+            cout << "\n  Winner: " << candidateNames[result.winner];
+            if (result.rounds.size() == 1) cout << " (first-preference majority)";
+            cout << "\n";
+        }
+        cout << "  Ballots: " << ballotCount << " | Rounds: " << result.rounds.size() << "\n";
+        cout << "  [TIME] Tabulation: " << fixed << setprecision(3) << result.seconds * 1000.0
+             << " ms on " << threads << " thread(s)\n\n";
+    }
+};
+
+const unsigned char InstantRunoffTally::NO_CHOICE;
+const unsigned char InstantRunoffTally::EXHAUSTED;
+const int InstantRunoffTally::MAX_CANDIDATES;
+
+// Point-in-time copy of what the exporter needs. Sealed blocks are immutable,
+// so the ledger part is just the first block and how many blocks to walk.
+// Readers on other threads walk VoteRecord::next only, and never read the
+// next field of the snapshot's last block, which the voting thread sets when
+// it seals the following block. They must not call the storage's at().
+struct ExportSnapshot {
+    const VoteRecord* firstBlock;
+    int blockCount;
+    long long voteCount;
+    vector<string> candidateNames;
+    vector<pair<string, int> > tallies;
+    vector<pair<string, bool> > turnout;
+    string headHash;
+    time_t takenAt;
+    
+    ExportSnapshot() : firstBlock(NULL), blockCount(0), voteCount(0), takenAt(time(NULL)) {}
+    
+    // Scheduled export: voters whose vote landed in a block sealed after
+    // their flag was copied into turnout (see BasicVotingSystem::runAdminSlice)
+    unordered_set<string> votedLate;
+    
+    bool hasVoted(size_t row) const {
+        return turnout[row].second || (!votedLate.empty() && votedLate.count(turnout[row].first) > 0);
+    }
+};
+
+// Writes ledger, turnout and tallies as CSV, and the ledger also as a
+// compressed columnar binary file (.evc). Ledger chunks are encoded in
+// parallel and written in order through large stdio buffers.
+//
+// .evc layout: "EVCOL1\n", u32 candidate count, candidate names, u64 blocks,
+// u64 votes, then chunks of "CHNK" u32 blocks u32 votes u64 payload-size
+// followed by the column payload (see encodeBinaryChunk).
+class ResultExporter {
+public:
+    struct Stats {
+        long long csvBytes;
+        long long binaryBytes;
+        int blocks;
+        long long votes;
+        double seconds;
+        bool success;
+        Stats() : csvBytes(0), binaryBytes(0), blocks(0), votes(0), seconds(0), success(false) {}
+    };
+    
+private:
+    static const size_t STREAM_BUFFER = 8 << 20;
+    static const size_t STEP_BUFFER = 64 << 10;   // stepped export: one flush fits in a step
+    
+    struct ChunkJob {
+        const VoteRecord* first;
+        int count;
+        string csv;
+        string binary;
+    };
+    
+    int threads;
+    int blocksPerChunk;
+    
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+    
+    // Hex digests packed two digits per byte; length is tagged in the low bit
+    static void putHash(string& out, const string& hash) {
+        unsigned char packed[64];
+        size_t bytes = (hash.size() + 1) / 2;
+        bool packable = bytes <= sizeof(packed);
+        for (size_t i = 0; i < hash.size() && packable; i += 2) {
+            int high = hexValue(hash[i]);
+            int low = (i + 1 < hash.size()) ? hexValue(hash[i + 1]) : 0;
+            packable = high >= 0 && low >= 0;
+            packed[i / 2] = (unsigned char)((high << 4) | low);
+        }
+        if (!packable) {
+            putVarint(out, (unsigned long long)hash.size() << 1);
+            out += hash;
+            return;
+        }
+        putVarint(out, ((unsigned long long)hash.size() << 1) | 1);
+        out.append((const char*)packed, bytes);
+    }
+    
+    static void appendCsvField(string& out, string_view value) {
+        if (value.find_first_of(",\"\n") == string_view::npos) {
+            out.append(value.data(), value.size());
+            return;
+        }
+        out += '"';
+        for (size_t i = 0; i < value.size(); i++) {
+            if (value[i] == '"') out += '"';
+            out += value[i];
+        }
+        out += '"';
+    }
+    
+    static void appendNumber(string& out, long long value) {
+        char buf[24];
+        int len = snprintf(buf, sizeof(buf), "%lld", value);
+        out.append(buf, len);
+    }
+    
+    static void encodeCsvChunk(ChunkJob& job) {
+        TimestampFormatter blockTime("%Y-%m-%d %H:%M:%S");
+        TimestampFormatter voteTime("%Y-%m-%d %H:%M:%S");
+        const VoteRecord* block = job.first;
+        job.csv.reserve((size_t)job.count * 128);
+        for (int k = 0; k < job.count; k++) {
+            for (size_t i = 0; i < block->votes.size(); i++) {
+                const VoteEntry& vote = block->votes[i];
+                appendNumber(job.csv, block->blockNumber);
+                job.csv += ',';
+                job.csv += blockTime.format(block->timestamp);
+                job.csv += ',';
+                job.csv += voteTime.format(vote.timestamp);
+                job.csv += ',';
+                appendCsvField(job.csv, vote.voterID);
+                job.csv += ',';
+                appendCsvField(job.csv, vote.candidate);
+                job.csv += ',';
+                appendCsvField(job.csv, vote.rankedChoices);
+                job.csv += ',';
+                job.csv += block->transactionsRoot;
+                job.csv += ',';
+                job.csv += block->hash;
+                job.csv += ',';
+                job.csv += block->previousHash;
+                job.csv += '\n';
+            }
+            if (k + 1 < job.count) block = block->next;
+        }
+    }
+    
+    // Column payload: block numbers (first + deltas), block timestamps (deltas),
+    // votes per block, block hashes, transaction roots, first previous hash,
+    // vote timestamps (deltas), voter IDs (front coded), candidate ordinals
+    // (255 + name when unknown), ranked choices
+    static void encodeBinaryChunk(ChunkJob& job, const vector<string>& candidateNames) {
+        vector<const VoteRecord*> blocks(job.count);
+        const VoteRecord* block = job.first;
+        long long votes = 0;
+        for (int k = 0; k < job.count; k++) {
+            blocks[k] = block;
+            votes += block->votes.size();
+            if (k + 1 < job.count) block = block->next;
+        }
+        string payload;
+        payload.reserve(votes * 24 + job.count * 32);
+        long long previous = 0;
+        for (int k = 0; k < job.count; k++) {
+            putSigned(payload, blocks[k]->blockNumber - previous);
+            previous = blocks[k]->blockNumber;
+        }
+        previous = 0;
+        for (int k = 0; k < job.count; k++) {
+            putSigned(payload, (long long)blocks[k]->timestamp - previous);
+            previous = (long long)blocks[k]->timestamp;
+        }
+        for (int k = 0; k < job.count; k++) putVarint(payload, blocks[k]->votes.size());
+        for (int k = 0; k < job.count; k++) putHash(payload, blocks[k]->hash);
+        for (int k = 0; k < job.count; k++) putHash(payload, blocks[k]->transactionsRoot);
+        if (job.count > 0) putHash(payload, blocks[0]->previousHash);
+        
+        previous = 0;
+        for (int k = 0; k < job.count; k++) {
+            for (size_t i = 0; i < blocks[k]->votes.size(); i++) {
+                putSigned(payload, (long long)blocks[k]->votes[i].timestamp - previous);
+                previous = (long long)blocks[k]->votes[i].timestamp;
+            }
+        }
+        string_view last;
+        for (int k = 0; k < job.count; k++) {
+            for (size_t i = 0; i < blocks[k]->votes.size(); i++) {
+                string_view id = blocks[k]->votes[i].voterID.view();
+                size_t shared = 0;
+                while (shared < id.size() && shared < last.size() && id[shared] == last[shared]) {
+                    shared++;
+                }
+                putVarint(payload, shared);
+                putVarint(payload, id.size() - shared);
+                payload.append(id.data() + shared, id.size() - shared);
+                last = id;
+            }
+        }
+        for (int k = 0; k < job.count; k++) {
+            for (size_t i = 0; i < blocks[k]->votes.size(); i++) {
+                string_view name = blocks[k]->votes[i].candidate.view();
+                size_t ordinal = 0;
+                while (ordinal < candidateNames.size() && candidateNames[ordinal] != name) ordinal++;
+                if (ordinal < candidateNames.size() && ordinal < 255) {
+                    payload += (char)ordinal;
+                } else {
+                    payload += (char)255;
+                    putString(payload, name);
+                }
+            }
+        }
+        for (int k = 0; k < job.count; k++) {
+            for (size_t i = 0; i < blocks[k]->votes.size(); i++) {
+                putString(payload, blocks[k]->votes[i].rankedChoices);
+            }
+        }
+        job.binary.clear();
+        job.binary += "CHNK";
+        putFixed(job.binary, job.count, 4);
+        putFixed(job.binary, votes, 4);
+        putFixed(job.binary, payload.size(), 8);
+        job.binary += payload;
+    }
+    
+    static FILE* openStream(const string& path, size_t buffer = STREAM_BUFFER) {
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file != NULL) {
+            setvbuf(file, NULL, _IOFBF, buffer);
+        }
+        return file;
+    }
+    
+    static bool writeAll(FILE* file, const string& data, long long& counter) {
+        if (data.empty()) return true;
+        counter += data.size();
+        return fwrite(data.data(), 1, data.size(), file) == data.size();
+    }
+    
+    // Opens both ledger files and writes their headers; false closes them again
+    static bool openLedger(const ExportSnapshot& snapshot, const string& prefix, size_t buffer,
+                           FILE*& csv, FILE*& binary, Stats& stats) {
+        csv = openStream(prefix + "_ledger.csv", buffer);
+        binary = openStream(prefix + "_ledger.evc", buffer);
+        bool ok = csv != NULL && binary != NULL
+                  && writeAll(csv, "block,block_time,vote_time,voter_id,candidate,ranked_choices,"
+                                   "tx_root,block_hash,previous_hash\n", stats.csvBytes);
+        if (ok) {
+            string header = "EVCOL1\n";
+            putFixed(header, snapshot.candidateNames.size(), 4);
+            for (size_t i = 0; i < snapshot.candidateNames.size(); i++) {
+                putString(header, snapshot.candidateNames[i]);
+            }
+            putFixed(header, snapshot.blockCount, 8);
+            putFixed(header, snapshot.voteCount, 8);
+            ok = writeAll(binary, header, stats.binaryBytes);
+        }
+        if (!ok) {
+            if (csv != NULL) fclose(csv);
+            if (binary != NULL) fclose(binary);
+            csv = binary = NULL;
+        }
+        return ok;
+    }
+    
+    bool writeLedger(const ExportSnapshot& snapshot, const string& prefix, Stats& stats) {
+        FILE* csv;
+        FILE* binary;
+        if (!openLedger(snapshot, prefix, STREAM_BUFFER, csv, binary, stats)) return false;
+        bool ok = true;
+        
+        // Walk the chain one batch of chunks ahead, encode the batch in
+        // parallel, then stream the encoded chunks out in block order
+        vector<ChunkJob> jobs(threads);
+        const VoteRecord* cursor = snapshot.firstBlock;
+        int remaining = snapshot.blockCount;
+        while (ok && remaining > 0) {
+            int jobCount = 0;
+            while (jobCount < threads && remaining > 0) {
+                ChunkJob& job = jobs[jobCount++];
+                job.first = cursor;
+                job.count = min(blocksPerChunk, remaining);
+                job.csv.clear();
+                remaining -= job.count;
+                if (remaining > 0) {
+                    for (int k = 0; k < job.count; k++) cursor = cursor->next;
+                }
+            }
+            const vector<string>& names = snapshot.candidateNames;
+            parallelFor(jobCount, jobCount, [&](int, size_t begin, size_t end) {
+                for (size_t j = begin; j < end; j++) {
+                    encodeCsvChunk(jobs[j]);
+                    encodeBinaryChunk(jobs[j], names);
+                }
+            });
+            for (int t = 0; t < jobCount && ok; t++) {
+                ok = writeAll(csv, jobs[t].csv, stats.csvBytes)
+                     && writeAll(binary, jobs[t].binary, stats.binaryBytes);
+                stats.blocks += jobs[t].count;
+            }
+        }
+        stats.votes = snapshot.voteCount;
+        ok = (fclose(csv) == 0) && ok;
+        ok = (fclose(binary) == 0) && ok;
+        return ok;
+    }
+    
+    bool writeTallies(const ExportSnapshot& snapshot, const string& prefix, Stats& stats) {
+        FILE* file = openStream(prefix + "_tallies.csv");
+        if (file == NULL) return false;
+        long long total = 0;
+        for (size_t i = 0; i < snapshot.tallies.size(); i++) total += snapshot.tallies[i].second;
+        string out = "candidate,votes,percent\n";
+        for (size_t i = 0; i < snapshot.tallies.size(); i++) {
+            char percent[32];
+            snprintf(percent, sizeof(percent), "%.2f",
+                     total > 0 ? snapshot.tallies[i].second * 100.0 / total : 0.0);
+            appendCsvField(out, snapshot.tallies[i].first);
+            out += ',';
+            appendNumber(out, snapshot.tallies[i].second);
+            out += ',';
+            out += percent;
+            out += '\n';
+        }
+        bool ok = writeAll(file, out, stats.csvBytes);
+        return (fclose(file) == 0) && ok;
+    }
+    
+    static void appendTurnoutRow(string& out, const ExportSnapshot& snapshot, size_t row) {
+        appendCsvField(out, snapshot.turnout[row].first);
+        out += snapshot.hasVoted(row) ? ",1\n" : ",0\n";
+    }
+    
+    bool writeTurnout(const ExportSnapshot& snapshot, const string& prefix, Stats& stats) {
+        FILE* file = openStream(prefix + "_turnout.csv");
+        if (file == NULL) return false;
+        string out = "voter_id,voted\n";
+        bool ok = true;
+        for (size_t i = 0; i < snapshot.turnout.size() && ok; i++) {
+            appendTurnoutRow(out, snapshot, i);
+            if (out.size() >= STREAM_BUFFER) {
+                ok = writeAll(file, out, stats.csvBytes);
+                out.clear();
+            }
+        }
+        ok = ok && writeAll(file, out, stats.csvBytes);
+        return (fclose(file) == 0) && ok;
+    }
+    
+public:
+    ResultExporter(int threadCount = defaultThreadCount(), int chunkBlocks = 4096)
+        : threads(threadCount < 1 ? 1 : threadCount), blocksPerChunk(chunkBlocks < 1 ? 1 : chunkBlocks) {}
+    
+    // Files: <prefix>_ledger.csv, <prefix>_ledger.evc, <prefix>_tallies.csv, <prefix>_turnout.csv
+    Stats exportAll(const ExportSnapshot& snapshot, const string& prefix) {
+        Stats stats;
+        auto start = high_resolution_clock::now();
+        stats.success = writeLedger(snapshot, prefix, stats)
+                        && writeTallies(snapshot, prefix, stats)
+                        && writeTurnout(snapshot, prefix, stats);
+        auto end = high_resolution_clock::now();
+        stats.seconds = duration_cast<microseconds>(end - start).count() / 1e6;
+        return stats;
+    }
+    
+    // Export in steps on the caller's thread, for admin slices. begin() writes
+    // the tallies and opens the ledger files, then each step() encodes up to
+    // `units` ledger blocks as one chunk, or writes up to `units` turnout rows
+    // once the ledger is done. Buffers are small enough to flush within a step.
+    struct Progress {
+        FILE* csv;
+        FILE* binary;
+        FILE* turnout;
+        const VoteRecord* next;
+        int remaining;
+        size_t row;
+        Stats stats;
+        high_resolution_clock::time_point start;
+        
+        Progress() : csv(NULL), binary(NULL), turnout(NULL), next(NULL), remaining(0), row(0) {}
+    };
+    
+    bool begin(const ExportSnapshot& snapshot, const string& prefix, Progress& progress) {
+        progress = Progress();
+        progress.start = high_resolution_clock::now();
+        progress.next = snapshot.firstBlock;
+        progress.remaining = snapshot.blockCount;
+        if (!writeTallies(snapshot, prefix, progress.stats)
+            || !openLedger(snapshot, prefix, STEP_BUFFER, progress.csv, progress.binary, progress.stats)) {
+            return false;
+        }
+        progress.turnout = openStream(prefix + "_turnout.csv", STEP_BUFFER);
+        if (progress.turnout == NULL || !writeAll(progress.turnout, "voter_id,voted\n", progress.stats.csvBytes)) {
+            abort(progress);
+            return false;
+        }
+        return true;
+    }
+    
+    // True once finished; progress.stats.success tells how it went
+    bool step(const ExportSnapshot& snapshot, Progress& progress, int units) {
+        bool ok = true;
+        if (progress.csv != NULL) {
+            if (progress.remaining > 0) {
+                ChunkJob job;
+                job.first = progress.next;
+                job.count = min(units, progress.remaining);
+                encodeCsvChunk(job);
+                encodeBinaryChunk(job, snapshot.candidateNames);
+                ok = writeAll(progress.csv, job.csv, progress.stats.csvBytes)
+                     && writeAll(progress.binary, job.binary, progress.stats.binaryBytes);
+                progress.stats.blocks += job.count;
+                progress.remaining -= job.count;
+                // The last block's next may be linked by a later seal; leave it alone
+                if (progress.remaining > 0) {
+                    for (int k = 0; k < job.count; k++) progress.next = progress.next->next;
+                }
+            }
+            if (ok && progress.remaining > 0) return false;
+            if (ok) {
+                ok = (fclose(progress.csv) == 0) && (fclose(progress.binary) == 0);
+                progress.csv = progress.binary = NULL;
+            }
+            if (ok) return false;
+        } else {
+            string out;
+            size_t end = min(snapshot.turnout.size(), progress.row + (size_t)units);
+            for (; progress.row < end; progress.row++) {
+                appendTurnoutRow(out, snapshot, progress.row);
+            }
+            ok = writeAll(progress.turnout, out, progress.stats.csvBytes);
+            if (ok && progress.row < snapshot.turnout.size()) return false;
+            if (ok) {
+                ok = fclose(progress.turnout) == 0;
+                progress.turnout = NULL;
+            }
+        }
+        abort(progress);
+        progress.stats.votes = snapshot.voteCount;
+        progress.stats.success = ok;
+        progress.stats.seconds = duration_cast<microseconds>(high_resolution_clock::now() - progress.start).count() / 1e6;
+        return true;
+    }
+    
+    // Close whatever a stepped export still has open
+    static void abort(Progress& progress) {
+        FILE* files[] = {progress.csv, progress.binary, progress.turnout};
+        for (FILE* file : files) {
+            if (file != NULL) fclose(file);
+        }
+        progress.csv = progress.binary = progress.turnout = NULL;
+    }
+};
+
+const size_t ResultExporter::STREAM_BUFFER;
+const size_t ResultExporter::STEP_BUFFER;
+
+// Long-running admin work, advanced in bounded steps by
+// BasicVotingSystem::runAdminSlice so it can be interleaved with votes
+enum AdminTask { ADMIN_AUDIT, ADMIN_SAVE, ADMIN_EXPORT, ADMIN_CHECKPOINT };
+
+const int ADMIN_PHASES = 6;
+
+struct AdminJob {
+    AdminTask task;
+    int phase;               // steps of one phase cost alike (0 to ADMIN_PHASES - 1)
+    bool started;
+    bool ok;
+    int cursor;              // next voter by registration order (save, export)
+    int end;                 // voters registered when the job started
+    FILE* file;              // save: <target>.tmp
+    long long oldBytes;      // save: size of the replaced file still to be released
+    string target;           // save/checkpoint file, or export prefix
+    ChainAudit audit;
+    ExportSnapshot snapshot;
+    const VoteRecord* lastCopied;   // export: last block sealed before voter flags were copied
+    int lateBlocks;                 // export: blocks after it still to scan for votedLate
+    ResultExporter::Progress progress;
+    
+    AdminJob(AdminTask t = ADMIN_AUDIT, const string& where = "")
+        : task(t), phase(0), started(false), ok(true), cursor(0), end(0), file(NULL), oldBytes(0), target(where),
+          lastCopied(NULL), lateBlocks(0) {
+        if (target.empty()) {
+            target = t == ADMIN_SAVE ? "voters.dat" : t == ADMIN_EXPORT ? "election"
+                   : t == ADMIN_CHECKPOINT ? "system.ckpt" : "";
+        }
+    }
+};
+
+const char* adminTaskName(AdminTask task) {
+    switch (task) {
+        case ADMIN_AUDIT: return "audit";
+        case ADMIN_SAVE: return "save";
+        case ADMIN_EXPORT: return "export";
+        case ADMIN_CHECKPOINT: return "checkpoint";
+    }
+    return "unknown";
+}
+
+// Phase timings of the last checkpoint restore, in seconds
+struct RestoreTimings {
+    double readSeconds;
+    double parseSeconds;
+    double verifySeconds;
+    double tallySeconds;
+    double voterSeconds;
+    double totalSeconds;
+    
+    RestoreTimings() : readSeconds(0), parseSeconds(0), verifySeconds(0),
+                       tallySeconds(0), voterSeconds(0), totalSeconds(0) {}
+};
+
+// Main voting system, assembled at compile time from the engines named by
+// Config (see the presets below)
+template <class Config>
+class BasicVotingSystem {
+public:
+    typedef typename Config::LogSink Log;
+    typedef typename Config::VoterStore VoterStore;
+    typedef typename Config::BlockHasher BlockHasher;
+    typedef BasicVoteLedger<typename Config::LedgerStorage, BlockHasher, Log> Ledger;
+    typedef typename Config::TallyEngine TallyEngine;
+    
+private:
+    VoterStore voterDB;
+    LedgerReplica replica;
+    Ledger ledger;
+    TallyEngine candidates;
+    InstantRunoffTally runoff;
+    bool candidatesInitialized;
+    thread exportThread;
+    atomic<bool> exportRunning;
+    thread checkpointThread;
+    atomic<bool> checkpointRunning;
+    atomic<bool> checkpointOk;
+    atomic<long long> checkpointMicros;
+    thread syncThread;
+    atomic<bool> syncRunning;
+    atomic<bool> syncOk;
+    RestoreTimings lastRestore;
+    
+    // Shared vote path: ranking[0] is the first (plurality) choice. The voter
+    // is looked up once and the handle is reused for the checks and marking;
+    // a single-choice ballot does not allocate once capacity is reserved.
+    bool castBallot(string_view voterID, const string_view* ranking, int rankCount) {
+        Log::write(LOG_INFO, "\n========== VOTE CASTING PROCESS ==========");
+        auto totalStart = high_resolution_clock::now();
+        try {
+            Voter* voter = voterDB.authenticateVoter(voterID);
+            if (voter == NULL) {
+                throw runtime_error("Authentication failed!");
+            }
+            if (voter->hasVoted) {
+                throw runtime_error("You have already voted!");
+            }
+            if (rankCount <= 0) {
+                throw runtime_error("Empty ballot!");
+            }
+            if (rankCount > runoff.getCandidateCount()) {
+                throw runtime_error("Too many preferences!");
+            }
+            unsigned char ordinals[InstantRunoffTally::MAX_CANDIDATES];
+            string rankedChoices;
+            for (int i = 0; i < rankCount; i++) {
+                if (!candidates.candidateExists(ranking[i])) {
+                    throw runtime_error("Invalid candidate!");
+                }
+                int ordinal = runoff.ordinalOf(ranking[i]);
+                for (int j = 0; j < i; j++) {
+                    if (ordinals[j] == ordinal) {
+                        throw runtime_error("Candidate ranked more than once!");
+                    }
+                }
+                ordinals[i] = (unsigned char)ordinal;
+                if (rankCount > 1) {
+                    if (i > 0) rankedChoices += ">";
+                    rankedChoices.append(ranking[i].data(), ranking[i].size());
+                }
+            }
+            if (!voterDB.markAsVoted(voter)) {
+                throw runtime_error("Failed to mark as voted");
+            }
+            ledger.addVote(voterID, ranking[0], rankedChoices);
+            candidates.addVote(ranking[0]);
+            runoff.addBallot(ordinals, rankCount);
+            auto totalEnd = high_resolution_clock::now();
+            auto totalDuration = duration_cast<microseconds>(totalEnd - totalStart);
+            if (rankedChoices.empty()) {
+                Log::write(LOG_INFO, "\n[SUCCESS] Vote successfully cast for {}!", ranking[0]);
+            } else {
+                Log::write(LOG_INFO, "\n[SUCCESS] Ranked vote successfully cast: {}", rankedChoices);
+            }
+            Log::write(LOG_DEBUG, "==========================================\n"
+                       "[TOTAL TIME] Complete voting process: {} microseconds\n"
+                       "             ({.3} milliseconds)\n"
+                       "==========================================\n",
+                       (long long)totalDuration.count(), totalDuration.count() / 1000.0);
+            return true;
+        } catch (const exception& e) {
+            Log::write(LOG_ERROR, "[ERROR] {}", e.what());
+            return false;
+        }
+    }
+    
+    // Ordinals for a ledger entry's ballot: the ranked list when present,
+    // otherwise the single candidate. Returns -1 if it names an unknown or
+    // repeated candidate or disagrees with the first choice.
+    int ballotOrdinals(const VoteEntry& vote, unsigned char* ordinals) const {
+        string_view ranked = vote.rankedChoices;
+        if (ranked.empty()) ranked = vote.candidate.view();
+        int count = 0;
+        while (true) {
+            size_t end = ranked.find('>');
+            string_view name = ranked.substr(0, end);
+            int ordinal = runoff.ordinalOf(name);
+            if (ordinal < 0 || count >= InstantRunoffTally::MAX_CANDIDATES) return -1;
+            if (count == 0 && name != vote.candidate.view()) return -1;
+            for (int j = 0; j < count; j++) {
+                if (ordinals[j] == ordinal) return -1;
+            }
+            ordinals[count++] = (unsigned char)ordinal;
+            if (end == string_view::npos) return count;
+            ranked.remove_prefix(end + 1);
+        }
+    }
+    
+    // Runs in the checkpoint child. Its copy-on-write view of memory is the
+    // state at fork time, so it can be walked while the parent keeps voting.
+    //
+    // Layout: "EVCKPT1\n", u64 time, tallies (name, votes), voters (encrypted
+    // ID, encrypted name, voted byte), block count, vote count, head hash,
+    // then each block (number, time, root, hash, previous hash, votes) and
+    // each vote (ID, candidate, ranked choices, time), then "EVEND\n".
+    bool writeCheckpoint(const string& path) {
+        string tempPath = path + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if (file == NULL) return false;
+        bool ok = true;
+        string out;
+        auto drain = [&](size_t threshold) {
+            if (out.size() >= threshold && !out.empty()) {
+                ok = ok && fwrite(out.data(), 1, out.size(), file) == out.size();
+                out.clear();
+            }
+        };
+        out = "EVCKPT1\n";
+        putFixed(out, (unsigned long long)time(NULL), 8);
+        vector<pair<string, int> > tallies;
+        candidates.collectResults(tallies);
+        putVarint(out, tallies.size());
+        for (size_t i = 0; i < tallies.size(); i++) {
+            putString(out, tallies[i].first);
+            putVarint(out, tallies[i].second);
+        }
+        putVarint(out, voterDB.getTotalVoters());
+        voterDB.forEachVoter([&](const Voter& voter) {
+            putString(out, voterDB.encryptField(voter.voterID));
+            putString(out, voterDB.encryptField(voter.name));
+            out += voter.hasVoted ? '\1' : '\0';
+            drain(1 << 20);
+        });
+        int blockCount = ledger.getBlockCount();
+        putVarint(out, blockCount);
+        putVarint(out, ledger.getTotalVotes());
+        putString(out, ledger.getHeadHash());
+        const VoteRecord* block = ledger.getFirstBlock();
+        for (int b = 0; b < blockCount; b++, block = block->next) {
+            putBlock(out, *block);
+            drain(1 << 20);
+        }
+        out += "EVEND\n";
+        drain(0);
+        ok = (fclose(file) == 0) && ok;
+        return ok && rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    
+public:
+    BasicVotingSystem() : candidatesInitialized(false), exportRunning(false), checkpointRunning(false),
+                          checkpointOk(false), checkpointMicros(0), syncRunning(false), syncOk(false) {}
+    
+    ~BasicVotingSystem() {
+        finishExport();
+        finishCheckpoint();
+        finishSync();
+        stopReplica();
+    }
+    
+    static const char* presetName() { return Config::name(); }
+    
+    void initializeCandidates() {
+        if (!candidatesInitialized) {
+            const char* names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+            for (int i = 0; i < 4; i++) {
+                candidates.addCandidate(names[i]);
+                runoff.addCandidate(names[i]);
+            }
+            candidatesInitialized = true;
+        }
+    }
+    
+    bool registerVoter(string_view id, string_view name) {
+        return voterDB.insertVoter(id, name);
+    }
+    
+    // Replica bytes for every registered voter to vote, doubled to leave room
+    // for later registrations. A menu vote usually seals a block of its own,
+    // so this allows a whole block per vote; the file stays sparse until written
+    unsigned long long replicaCapacity() const {
+        const unsigned long long BYTES_PER_VOTE = 256;
+        unsigned long long votes = max((unsigned long long)voterDB.getTotalVoters(),
+                                       (unsigned long long)ledger.getTotalVotes());
+        return max(2 * votes * BYTES_PER_VOTE, 1ull << 20);
+    }
+    
+    // Publish sealed blocks to a memory-mapped replica that --auditor processes
+    // tail; capacity 0 sizes it from the current voters and ledger
+    bool startReplica(const string& path = "ledger.replica", unsigned long long capacity = 0) {
+        if (capacity == 0) capacity = replicaCapacity();
+        ledger.attachReplica(NULL);
+        if (!replica.open(path, presetName(), capacity)) {
+            Log::write(LOG_ERROR, "[ERROR] Cannot create ledger replica {}: {}", path, strerror(errno));
+            return false;
+        }
+        ledger.attachReplica(&replica);
+        Log::write(LOG_INFO, "[INFO] Ledger replica published at {} ({} blocks so far)",
+                   path, (long long)replica.getPublishedBlocks());
+        return true;
+    }
+    
+    // Seal pending votes, publish them and mark the replica closed
+    void stopReplica() {
+        if (!replica.isOpen()) return;
+        ledger.commitPending();
+        ledger.attachReplica(NULL);
+        replica.close();
+    }
+    
+    // Pre-size the ballot columns so castVote stays off the heap
+    void reserveBallots(size_t ballots) {
+        runoff.reserve(ballots, 1);
+    }
+    
+    bool castVote(string_view voterID, string_view candidate) {
+        return castBallot(voterID, &candidate, 1);
+    }
+    
+    // Ranked ballot, candidates in order of preference
+    bool castRankedVote(string_view voterID, const vector<string>& ranking) {
+        vector<string_view> views(ranking.begin(), ranking.end());
+        return castBallot(voterID, views.data(), (int)views.size());
+    }
+    
+    void showResults() { candidates.displayResults(); }
+    
+    // Results as of a block number ("120") or a time of day today ("14:00")
+    void showHistoricalResults(const string& query) {
+        ledger.commitPending();
+        int blockNum = -1;
+        int hour, minute;
+        char extra;
+        if (sscanf(query.c_str(), "%d:%d%c", &hour, &minute, &extra) == 2) {
+            if (hour < 0 || hour > 23 || minute < 0 || minute > 59) {
+                Log::write(LOG_ERROR, "[ERROR] Invalid time: {}", query);
+                return;
+            }
+            time_t now = time(NULL);
+            struct tm local;
+            localtime_r(&now, &local);
+            local.tm_hour = hour;
+            local.tm_min = minute;
+            local.tm_sec = 59;
+            blockNum = ledger.blockAtTime(mktime(&local));
+        } else if (!query.empty() && query.find_first_not_of("0123456789") == string::npos && query.size() < 10) {
+            blockNum = atoi(query.c_str());
+        } else {
+            Log::write(LOG_ERROR, "[ERROR] Enter a block number or a time as HH:MM");
+            return;
+        }
+        
+        auto start = high_resolution_clock::now();
+        vector<pair<string, int> > history;
+        int replayed = 0;
+        if (!ledger.talliesAtBlock(blockNum, history, &replayed)) {
+            Log::write(LOG_ERROR, "[ERROR] Block #{} does not exist (ledger has {} blocks)",
+                       blockNum, ledger.getBlockCount());
+            return;
+        }
+        auto end = high_resolution_clock::now();
+        vector<pair<string, int> > results;
+        candidates.collectResults(results);
+        int total = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            results[i].second = 0;
+            for (size_t j = 0; j < history.size(); j++) {
+                if (history[j].first == results[i].first) results[i].second = history[j].second;
+            }
+            total += results[i].second;
+        }
+        Log::flush();
+        cout << "\n+========================================+\n";
+        cout << "|       HISTORICAL RESULTS               |\n";
+        cout << "+========================================+\n";
+        cout << "  As of block #" << blockNum << " of " << ledger.getBlockCount() << "\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            cout << "  " << setw(20) << left << results[i].first
+                 << ": " << results[i].second << " votes\n";
+        }
+        cout << "\n  Total votes: " << total << "\n";
+        cout << "  Replayed " << replayed << " block(s) from the nearest checkpoint (every "
+             << ledger.getCheckpointInterval() << " blocks)\n";
+        cout << "  [TIME] Query: " << duration_cast<microseconds>(end - start).count() << " microseconds\n\n";
+    }
+    void showRankedResults() { runoff.displayRounds(runoff.tabulate()); }
+    void showPercentages() { candidates.displayPercentages(); }
+    void showVoters() { voterDB.displayAllVoters(); }
+    
+    size_t searchVoters(bool byName, string_view prefix, size_t offset, size_t limit,
+                        vector<const Voter*>& out) {
+        return byName ? voterDB.searchByName(prefix, offset, limit, out)
+                      : voterDB.searchByID(prefix, offset, limit, out);
+    }
+    
+    // One page of voters whose ID or name starts with prefix; returns the page count
+    size_t showVoterSearch(bool byName, const string& prefix, size_t page, size_t pageSize = 20) {
+        auto start = high_resolution_clock::now();
+        vector<const Voter*> matches;
+        size_t total = searchVoters(byName, prefix, page * pageSize, pageSize, matches);
+        auto end = high_resolution_clock::now();
+        size_t pages = (total + pageSize - 1) / pageSize;
+        Log::flush();
+        cout << "\n+========================================+\n";
+        cout << "|       VOTER SEARCH                     |\n";
+        cout << "+========================================+\n";
+        cout << "  " << (byName ? "Name" : "ID") << " starts with \"" << prefix << "\" (case-insensitive)\n";
+        for (size_t i = 0; i < matches.size(); i++) {
+            cout << "  ID: " << setw(10) << left << matches[i]->voterID
+                 << " | Name: " << setw(20) << left << matches[i]->name
+                 << " | Voted: " << (matches[i]->hasVoted ? "YES" : "NO") << "\n";
+        }
+        if (total == 0) {
+            cout << "  No matching voters.\n";
+        } else {
+            cout << "\n  Showing " << page * pageSize + 1 << "-" << page * pageSize + matches.size()
+                 << " of " << total << " matches (page " << page + 1 << " of " << pages << ")\n";
+        }
+        cout << "  [TIME] Search: " << duration_cast<microseconds>(end - start).count() << " microseconds\n\n";
+        return pages;
+    }
+    void showLedger() { ledger.displayLedger(); }
+    void showHashStats() { voterDB.displayHashTableStats(); }
+    void auditBlockchain() { ledger.auditBlockchain(); }
+    
+    int getTotalVoters() const { return voterDB.getTotalVoters(); }
+    int getVotedCount() const { return voterDB.getVotedCount(); }
+    int getLedgerBlocks() const { return ledger.getBlockCount(); }
+    void commitLedger() { ledger.commitPending(); }
+    bool sealIfDue() { return ledger.sealIfDue(); }
+    int millisUntilSeal() const { return ledger.millisUntilSeal(); }
+    string getLedgerHeadHash() const { return ledger.getHeadHash(); }
+    string getLedgerHashAt(int blockNum) const { return ledger.getHashAt(blockNum); }
+    bool verifyLedger() { return ledger.verifyChain(); }
+    void collectResults(vector<pair<string, int> >& out) { candidates.collectResults(out); }
+    
+    void showDashboard() {
+        bool secure = ledger.verifyChain();
+        Log::flush();
+        cout << "\n+========================================+\n";
+        cout << "|       ADMIN DASHBOARD                  |\n";
+        cout << "+========================================+\n";
+        int total = voterDB.getTotalVoters();
+        int voted = voterDB.getVotedCount();
+        cout << "  Total Registered: " << total << "\n";
+        cout << "  Votes Cast: " << voted << "\n";
+        cout << "  Not Voted: " << (total - voted) << "\n";
+        if (total > 0) {
+            cout << "  Turnout: " << fixed << setprecision(1)
+                 << (voted * 100.0 / total) << "%\n";
+        }
+        cout << "  Blockchain Blocks: " << ledger.getBlockCount() << " ("
+             << ledger.getTotalVotes() << " votes)\n";
+        cout << "  Security: " << (secure ? "SECURE" : "COMPROMISED") << "\n\n";
+    }
+    
+    void showTimeComplexityAnalysis() {
+        cout << "\n+========================================+\n";
+        cout << "|   TIME COMPLEXITY ANALYSIS             |\n";
+        cout << "+========================================+\n";
+        cout << "\n1. HASH TABLE (Voter Database):\n";
+        cout << "   - Insert:  O(1) average (amortized), O(n) worst\n";
+        cout << "   - Search:  O(1) average, O(n) worst\n";
+        cout << "   - Delete:  O(1) average, O(n) worst\n";
+        cout << "   - Resize:  O(n) total, spread over the following inserts\n";
+        cout << "   * n = chain length at index\n";
+        cout << "   * Amortized O(1) due to dynamic resizing\n";
+        cout << "   - Prefix search: O(log n + k) over sorted ID/name indexes\n";
+        cout << "   * k = matches up to the requested page\n";
+        cout << "\n2. BLOCKCHAIN (Vote Ledger):\n";
+        cout << "   - Insert:  O(1) amortized - append to pending block\n";
+        cout << "   - Seal:    O(k) - Merkle root over k votes per block\n";
+        cout << "   - Verify:  O(n) - check all votes and block headers\n";
+        cout << "   - Search:  O(n) - linear traversal\n";
+        cout << "   * n = number of votes, k = votes per block\n";
+        cout << "\n3. BINARY SEARCH TREE (Candidates):\n";
+        cout << "   - Insert:  O(log n) average, O(n) worst\n";
+        cout << "   - Search:  O(log n) average, O(n) worst\n";
+        cout << "   - Traverse: O(n) - visit all nodes\n";
+        cout << "   * n = number of candidates\n";
+        cout << "\n4. COMPLETE VOTING OPERATION:\n";
+        cout << "   Total = O(1) amortized + O(1) + O(log n)\n";
+        cout << "   Result: O(log n) overall\n";
+        cout << "+========================================+\n\n";
+    }
+    
+    bool saveData(const string& path = "voters.dat") {
+        Log::write(LOG_INFO, "\n[SAVING] Saving system data...");
+        bool success = voterDB.saveToFile(path);
+        if (success) {
+            Log::write(LOG_INFO, "[SUCCESS] Data saved successfully!\n");
+        }
+        return success;
+    }
+    
+    // Voted flags come from the ledger, and voters.dat has none of it, so
+    // voter data is only reloaded while the ledger is empty and its flags
+    // are cleared. Once votes are cast, restore a checkpoint instead
+    bool loadData() {
+        Log::write(LOG_INFO, "\n[LOADING] Loading system data...");
+        if (ledger.getTotalVotes() > 0) {
+            Log::write(LOG_ERROR, "[ERROR] Voter data cannot be reloaded once the ledger holds votes");
+            return false;
+        }
+        bool success = voterDB.loadFromFile("voters.dat");
+        if (success) {
+            int cleared = voterDB.clearVotedFlags();
+            if (cleared > 0) {
+                Log::write(LOG_ALERT, "[ALERT] {} voters marked as voted in voters.dat have no votes in the ledger; "
+                           "their flags were cleared", cleared);
+            }
+            Log::write(LOG_INFO, "[SUCCESS] Data loaded successfully!\n");
+        }
+        return success;
+    }
+    
+    // Seal pending votes and copy tallies and turnout; the ledger itself is
+    // shared, since the exporter only reads blocks sealed before this point
+    ExportSnapshot takeSnapshot() {
+        ExportSnapshot snapshot;
+        snapshotLedger(snapshot);
+        voterDB.collectTurnout(snapshot.turnout);
+        return snapshot;
+    }
+    
+    void snapshotLedger(ExportSnapshot& snapshot) {
+        ledger.commitPending();
+        snapshot.takenAt = time(NULL);
+        snapshot.firstBlock = ledger.getFirstBlock();
+        snapshot.blockCount = ledger.getBlockCount();
+        snapshot.voteCount = ledger.getTotalVotes();
+        snapshot.headHash = ledger.getHeadHash();
+        for (int i = 0; i < runoff.getCandidateCount(); i++) {
+            snapshot.candidateNames.push_back(runoff.candidateName(i));
+        }
+        candidates.collectResults(snapshot.tallies);
+    }
+    
+    // Export in the background; voting can continue while files are written
+    void startExport(const string& prefix = "election") {
+        finishExport();
+        launchExport(takeSnapshot(), prefix);
+    }
+    
+    // The export thread runs as SCHED_IDLE, so on a busy core it only takes
+    // time the voting thread leaves unused
+    void launchExport(ExportSnapshot snapshot, const string& prefix) {
+        Log::write(LOG_INFO, "\n[EXPORT] Exporting {} blocks ({} votes) to {}_*...",
+                   snapshot.blockCount, snapshot.voteCount, prefix);
+        exportRunning.store(true);
+        exportThread = thread([this, snapshot = move(snapshot), prefix]() {
+            struct sched_param idle;
+            idle.sched_priority = 0;
+            sched_setscheduler(0, SCHED_IDLE, &idle);
+            ResultExporter exporter;
+            ResultExporter::Stats stats = exporter.exportAll(snapshot, prefix);
+            if (stats.success) {
+                Log::write(LOG_INFO, "[EXPORT] Done: {} blocks, {} CSV bytes, {} binary bytes in {.3} s",
+                           stats.blocks, stats.csvBytes, stats.binaryBytes, stats.seconds);
+            } else {
+                Log::write(LOG_ERROR, "[ERROR] Export to {}_* failed", prefix);
+            }
+            exportRunning.store(false);
+        });
+    }
+    
+    bool isExportRunning() const { return exportRunning.load(); }
+    
+    void finishExport() {
+        if (exportThread.joinable()) {
+            exportThread.join();
+        }
+    }
+    
+    // Checkpoint voters, voted flags, ledger and tallies at one consistent
+    // point without stopping voting: a forked child serializes its
+    // copy-on-write image while a background thread waits for it
+    bool startCheckpoint(const string& path = "system.ckpt") {
+        if (checkpointRunning.load()) {
+            Log::write(LOG_ERROR, "[ERROR] A checkpoint is already in progress");
+            return false;
+        }
+        finishCheckpoint();
+        ledger.commitPending();
+        auto start = high_resolution_clock::now();
+        pid_t pid = fork();
+        if (pid < 0) {
+            Log::write(LOG_ERROR, "[ERROR] fork failed: {}", strerror(errno));
+            return false;
+        }
+        if (pid == 0) {
+            AsyncLogger::instance().afterFork();
+            AsyncLogger::instance().setLevel(LOG_ALERT);
+            _exit(writeCheckpoint(path) ? 0 : 1);
+        }
+        auto forked = high_resolution_clock::now();
+        checkpointRunning.store(true);
+        Log::write(LOG_INFO, "\n[CHECKPOINT] Snapshot of {} voters and {} votes taken ({} microseconds pause)",
+                   voterDB.getTotalVoters(), ledger.getTotalVotes(),
+                   (long long)duration_cast<microseconds>(forked - start).count());
+        checkpointThread = thread([this, pid, path, start]() {
+            int status = 0;
+            pid_t done;
+            do {
+                done = waitpid(pid, &status, 0);
+            } while (done < 0 && errno == EINTR);
+            bool ok = done == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            long long micros = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+            if (ok) {
+                Log::write(LOG_INFO, "[CHECKPOINT] Saved {} in {.3} s", path, micros / 1e6);
+            } else {
+                Log::write(LOG_ERROR, "[ERROR] Checkpoint to {} failed", path);
+            }
+            checkpointMicros.store(micros);
+            checkpointOk.store(ok);
+            checkpointRunning.store(false);
+        });
+        return true;
+    }
+    
+    bool isCheckpointRunning() const { return checkpointRunning.load(); }
+    
+    // Wait for the running checkpoint; true if the last one succeeded
+    bool finishCheckpoint() {
+        if (checkpointThread.joinable()) {
+            checkpointThread.join();
+        }
+        return checkpointOk.load();
+    }
+    
+    long long getLastCheckpointMicros() const { return checkpointMicros.load(); }
+    
+    // fdatasync (fsync for a directory) on a helper thread, so an admin slice
+    // polls for the disk instead of waiting on it; the descriptor is closed
+    // afterwards when `owned`
+    void startSync(int fd, bool owned, bool directory) {
+        finishSync();
+        syncRunning.store(true);
+        syncThread = thread([this, fd, owned, directory]() {
+            bool ok = (directory ? fsync(fd) : fdatasync(fd)) == 0;
+            if (owned) ok = (::close(fd) == 0) && ok;
+            syncOk.store(ok);
+            syncRunning.store(false);
+        });
+    }
+    
+    bool isSyncRunning() const { return syncRunning.load(); }
+    
+    bool finishSync() {
+        if (syncThread.joinable()) {
+            syncThread.join();
+        }
+        return syncOk.load();
+    }
+    
+    // Advance an admin job by up to `units` steps (ledger blocks, tally
+    // intervals, voters or turnout rows); true once it has finished. job.phase
+    // names the kind of step the next call takes. Votes and registrations
+    // may run between calls:
+    //   audit      - checks the blocks sealed when it started, then the tally intervals
+    //   save       - writes <target>.tmp in registration order, syncs it on a helper
+    //                thread, renames it, then releases the replaced file a piece at a time
+    //   export     - copies voter IDs and flags, snapshots the ledger, marks voters
+    //                whose vote came after their flag was copied, then encodes ledger
+    //                chunks and turnout rows
+    //   checkpoint - the same snapshot, then voters and ledger blocks written as
+    //                writeCheckpoint does, synced and renamed (no fork)
+    bool runAdminSlice(AdminJob& job, int units) {
+        switch (job.task) {
+            case ADMIN_AUDIT: {
+                if (!job.started) {
+                    ledger.beginAudit(job.audit);
+                    job.started = true;
+                }
+                bool audited = ledger.continueAudit(job.audit, units);
+                job.phase = job.audit.checkedBlocks < job.audit.lastBlock ? 0 : 1;
+                if (!audited) return false;
+                job.ok = job.audit.chainValid && job.audit.talliesValid;
+                ledger.displayAuditReport(job.audit.chainValid, job.audit.talliesValid);
+                return true;
+            }
+                
+            case ADMIN_SAVE: {
+                string temp = job.target + ".tmp";
+                string old = job.target + ".old";
+                if (!job.started) {
+                    job.started = true;
+                    job.end = voterDB.getTotalVoters();
+                    job.file = fopen(temp.c_str(), "wb");
+                    if (job.file == NULL) {
+                        Log::write(LOG_ERROR, "[ERROR] Save failed: Cannot open file");
+                        job.ok = false;
+                        return true;
+                    }
+                    Log::write(LOG_INFO, "\n[SAVING] Saving {} voters in steps...", job.end);
+                }
+                if (job.phase == 0) {
+                    int to = min(job.end, job.cursor + units);
+                    job.ok = voterDB.saveRange(job.file, job.cursor, to) && job.ok;
+                    job.cursor = to;
+                    if (job.ok && job.cursor < job.end) return false;
+                    job.ok = (fflush(job.file) == 0) && job.ok;
+                    if (!job.ok) {
+                        Log::write(LOG_ERROR, "[ERROR] Save failed: {}", strerror(errno));
+                        fclose(job.file);
+                        job.file = NULL;
+                        remove(temp.c_str());
+                        return true;
+                    }
+                    // The old file is moved aside rather than renamed over, so
+                    // nothing else flushes the new one: sync it before it is named
+                    startSync(fileno(job.file), false, false);
+                    job.phase = 1;
+                    return false;
+                }
+                if (job.phase == 1) {
+                    if (isSyncRunning()) return false;
+                    job.ok = finishSync();
+                    job.ok = (fclose(job.file) == 0) && job.ok;
+                    job.file = NULL;
+                    // Only a complete, synced file replaces the old one. That is moved
+                    // to <target>.old first: renaming over it would free its blocks
+                    // inline, which takes milliseconds per megabyte
+                    struct stat previous;
+                    bool movedAside = false;
+                    if (job.ok && stat(job.target.c_str(), &previous) == 0) {
+                        movedAside = rename(job.target.c_str(), old.c_str()) == 0;
+                        job.ok = movedAside;
+                        job.oldBytes = previous.st_size;
+                    }
+                    if (job.ok && rename(temp.c_str(), job.target.c_str()) != 0) {
+                        job.ok = false;
+                        if (movedAside) rename(old.c_str(), job.target.c_str());
+                    }
+                    if (!job.ok) {
+                        Log::write(LOG_ERROR, "[ERROR] Save failed: {}", strerror(errno));
+                        remove(temp.c_str());
+                        return true;
+                    }
+                    // Then make the renames themselves durable
+                    int fd = open(directoryOf(job.target).c_str(), O_RDONLY | O_DIRECTORY);
+                    if (fd >= 0) startSync(fd, true, true);
+                    job.phase = 2;
+                    return false;
+                }
+                if (job.phase == 2) {
+                    if (isSyncRunning()) return false;
+                    if (!finishSync()) {
+                        Log::write(LOG_WARN, "[WARNING] Could not sync the directory of {}", job.target);
+                    }
+                    Log::write(LOG_INFO, "[SUCCESS] Data saved successfully!\n");
+                    job.phase = 3;
+                    return false;
+                }
+                // About the cost of writing one voter per unit
+                job.oldBytes = max(0LL, job.oldBytes - units * 1024LL);
+                if (job.oldBytes > 0 && truncate(old.c_str(), job.oldBytes) == 0) return false;
+                remove(old.c_str());
+                return true;
+            }
+                
+            case ADMIN_EXPORT: {
+                if (!job.started) {
+                    if (isExportRunning()) return false;
+                    finishExport();
+                    job.started = true;
+                }
+                if (job.phase < 2) {
+                    if (!snapshotInSteps(job, units)) return false;
+                    Log::write(LOG_INFO, "\n[EXPORT] Exporting {} blocks ({} votes) to {}_* in steps...",
+                               job.snapshot.blockCount, job.snapshot.voteCount, job.target);
+                    if (!ResultExporter(1).begin(job.snapshot, job.target, job.progress)) {
+                        Log::write(LOG_ERROR, "[ERROR] Export to {}_* failed", job.target);
+                        job.ok = false;
+                        return true;
+                    }
+                    return false;
+                }
+                bool done = ResultExporter(1).step(job.snapshot, job.progress, units);
+                job.phase = job.progress.csv != NULL ? 2 : 3;
+                if (!done) return false;
+                const ResultExporter::Stats& stats = job.progress.stats;
+                job.ok = stats.success;
+                if (stats.success) {
+                    Log::write(LOG_INFO, "[EXPORT] Done: {} blocks, {} CSV bytes, {} binary bytes in {.3} s",
+                               stats.blocks, stats.csvBytes, stats.binaryBytes, stats.seconds);
+                } else {
+                    Log::write(LOG_ERROR, "[ERROR] Export to {}_* failed", job.target);
+                }
+                return true;
+            }
+                
+            case ADMIN_CHECKPOINT:
+                return checkpointInSteps(job, units);
+        }
+        return true;
+    }
+    
+    // Phases 0-1 of an export or checkpoint job: a consistent snapshot taken
+    // without stopping votes. Voter IDs and voted flags are copied a few at a
+    // time, following registrations until caught up, and the ledger and
+    // tallies are snapshotted in that same step. A voter copied as not voted
+    // may have voted since; every such vote is in a block sealed after the
+    // copy began, so those blocks are scanned into votedLate. True once done
+    // (job.phase is then 2).
+    bool snapshotInSteps(AdminJob& job, int units) {
+        if (job.phase == 0) {
+            if (job.cursor == 0) {
+                ledger.commitPending();
+                job.lastCopied = ledger.getLastBlock();
+                job.snapshot.turnout.reserve(voterDB.getTotalVoters());
+            }
+            int to = min(voterDB.getTotalVoters(), job.cursor + units);
+            for (; job.cursor < to; job.cursor++) {
+                const Voter* voter = voterDB.voterAt(job.cursor);
+                job.snapshot.turnout.push_back(make_pair(voter->voterID, voter->hasVoted));
+            }
+            if (job.cursor < voterDB.getTotalVoters()) return false;
+            snapshotLedger(job.snapshot);
+            int copiedBlocks = job.lastCopied == NULL ? 0 : job.lastCopied->blockNumber;
+            job.lateBlocks = job.snapshot.blockCount - copiedBlocks;
+            if (job.lateBlocks > 0) {
+                job.lastCopied = job.lastCopied == NULL ? job.snapshot.firstBlock : job.lastCopied->next;
+            }
+            job.phase = 1;
+            return false;
+        }
+        for (int b = 0; b < units && job.lateBlocks > 0; b++) {
+            for (size_t i = 0; i < job.lastCopied->votes.size(); i++) {
+                job.snapshot.votedLate.insert(string(job.lastCopied->votes[i].voterID.view()));
+            }
+            if (--job.lateBlocks > 0) job.lastCopied = job.lastCopied->next;
+        }
+        if (job.lateBlocks > 0) return false;
+        job.phase = 2;
+        return true;
+    }
+    
+    // A checkpoint in steps, in the format writeCheckpoint uses, without a
+    // fork: snapshot (phases 0-1), then voters (2) and ledger blocks (3) to
+    // <target>.tmp, then an fdatasync (4) and the rename and directory sync
+    // (5) on the helper thread
+    bool checkpointInSteps(AdminJob& job, int units) {
+        string temp = job.target + ".tmp";
+        if (!job.started) {
+            if (isCheckpointRunning()) return false;
+            job.started = true;
+        }
+        if (job.phase < 2) {
+            if (!snapshotInSteps(job, units)) return false;
+            Log::write(LOG_INFO, "\n[CHECKPOINT] Saving {} voters and {} votes to {} in steps...",
+                       job.snapshot.turnout.size(), job.snapshot.voteCount, job.target);
+            job.file = fopen(temp.c_str(), "wb");
+            if (job.file == NULL) {
+                Log::write(LOG_ERROR, "[ERROR] Checkpoint to {} failed: {}", job.target, strerror(errno));
+                job.ok = false;
+                return true;
+            }
+            setvbuf(job.file, NULL, _IOFBF, 64 << 10);
+            string out = "EVCKPT1\n";
+            putFixed(out, (unsigned long long)job.snapshot.takenAt, 8);
+            putVarint(out, job.snapshot.tallies.size());
+            for (size_t i = 0; i < job.snapshot.tallies.size(); i++) {
+                putString(out, job.snapshot.tallies[i].first);
+                putVarint(out, job.snapshot.tallies[i].second);
+            }
+            putVarint(out, job.snapshot.turnout.size());
+            job.ok = fwrite(out.data(), 1, out.size(), job.file) == out.size();
+            job.cursor = 0;
+            job.lastCopied = job.snapshot.firstBlock;
+            job.lateBlocks = job.snapshot.blockCount;
+        } else if (job.phase == 2) {
+            string out;
+            int to = min((int)job.snapshot.turnout.size(), job.cursor + units);
+            for (; job.cursor < to; job.cursor++) {
+                putString(out, voterDB.encryptField(job.snapshot.turnout[job.cursor].first));
+                putString(out, voterDB.encryptField(voterDB.voterAt(job.cursor)->name));
+                out += job.snapshot.hasVoted(job.cursor) ? '\1' : '\0';
+            }
+            job.ok = fwrite(out.data(), 1, out.size(), job.file) == out.size();
+            if (job.ok && job.cursor == (int)job.snapshot.turnout.size()) {
+                out.clear();
+                putVarint(out, job.snapshot.blockCount);
+                putVarint(out, job.snapshot.voteCount);
+                putString(out, job.snapshot.headHash);
+                job.ok = fwrite(out.data(), 1, out.size(), job.file) == out.size();
+                job.phase = 3;
+            }
+        } else if (job.phase == 3) {
+            string out;
+            for (int b = 0; b < units && job.lateBlocks > 0; b++) {
+                putBlock(out, *job.lastCopied);
+                // The last block's next may be linked by a later seal
+                if (--job.lateBlocks > 0) job.lastCopied = job.lastCopied->next;
+            }
+            if (job.lateBlocks == 0) out += "EVEND\n";
+            job.ok = fwrite(out.data(), 1, out.size(), job.file) == out.size();
+            if (job.ok && job.lateBlocks == 0) {
+                job.ok = fflush(job.file) == 0;
+                if (job.ok) startSync(fileno(job.file), false, false);
+                job.phase = 4;
+            }
+        } else if (job.phase == 4) {
+            if (isSyncRunning()) return false;
+            job.ok = finishSync();
+            job.ok = (fclose(job.file) == 0) && job.ok;
+            job.file = NULL;
+            job.ok = job.ok && rename(temp.c_str(), job.target.c_str()) == 0;
+            if (job.ok) {
+                int fd = open(directoryOf(job.target).c_str(), O_RDONLY | O_DIRECTORY);
+                if (fd >= 0) startSync(fd, true, true);
+                job.phase = 5;
+            }
+        } else {
+            if (isSyncRunning()) return false;
+            finishSync();
+            Log::write(LOG_INFO, "[CHECKPOINT] Saved {}", job.target);
+            return true;
+        }
+        if (job.ok) return false;
+        Log::write(LOG_ERROR, "[ERROR] Checkpoint to {} failed: {}", job.target, strerror(errno));
+        finishSync();
+        if (job.file != NULL) fclose(job.file);
+        job.file = NULL;
+        remove(temp.c_str());
+        return true;
+    }
+    
+    static string directoryOf(const string& path) {
+        size_t slash = path.rfind('/');
+        return slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    }
+    
+    // Drop an unfinished job, releasing anything it holds
+    void cancelAdminJob(AdminJob& job) {
+        if (job.task == ADMIN_SAVE || job.task == ADMIN_CHECKPOINT) finishSync();
+        if (job.file != NULL) {
+            fclose(job.file);
+            job.file = NULL;
+            remove((job.target + ".tmp").c_str());
+        }
+        // The replaced file is only released once the new one is in place
+        if (job.task == ADMIN_SAVE && job.phase >= 2 && job.ok) {
+            remove((job.target + ".old").c_str());
+        }
+        if (job.task == ADMIN_EXPORT) ResultExporter::abort(job.progress);
+    }
+    
+    // Restore voters and ledger from a checkpoint into an empty system, then
+    // rebuild tallies and voted flags from the ledger itself: block hashes
+    // are rechecked and first choices histogrammed in parallel. The rebuilt
+    // state must match the tallies and flags stored in the checkpoint, and
+    // nothing is kept unless every check passes.
+    bool restoreCheckpoint(const string& path = "system.ckpt") {
+        auto start = high_resolution_clock::now();
+        lastRestore = RestoreTimings();
+        try {
+            ifstream file(path.c_str(), ios::binary);
+            if (!file.is_open()) return false;
+            Log::write(LOG_INFO, "\n[RESTORE] Restoring system state from {}...", path);
+            if (voterDB.getTotalVoters() > 0 || ledger.getTotalVotes() > 0) {
+                throw runtime_error("Restore requires an empty system");
+            }
+            string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+            auto readEnd = high_resolution_clock::now();
+            ByteReader in(data);
+            if (!in.expect("EVCKPT1\n")) {
+                throw runtime_error("Not a checkpoint file");
+            }
+            in.getFixed(8);
+            
+            vector<pair<string, int> > storedTallies;
+            for (unsigned long long n = in.getVarint(); n > 0; n--) {
+                string name(in.getString());
+                storedTallies.push_back(make_pair(name, (int)in.getVarint()));
+            }
+            
+            vector<Voter> voters;
+            for (unsigned long long n = in.getVarint(); n > 0; n--) {
+                string voterID = voterDB.decryptField(string(in.getString()));
+                string name = voterDB.decryptField(string(in.getString()));
+                if (!isValidID(voterID) || !isValidName(name)) {
+                    throw runtime_error("Invalid voter record");
+                }
+                voters.push_back(Voter(voterID, name));
+                voters.back().hasVoted = in.getFixed(1) != 0;
+            }
+            
+            unsigned long long blockCount = in.getVarint();
+            unsigned long long voteCount = in.getVarint();
+            string headHash(in.getString());
+            vector<VoteRecord> blocks;
+            blocks.reserve(min(blockCount, (unsigned long long)in.remaining()));
+            string previousHash = "0";
+            for (unsigned long long b = 0; b < blockCount; b++) {
+                blocks.push_back(VoteRecord());
+                VoteRecord& block = blocks.back();
+                getBlock(in, block);
+                if (block.blockNumber != (int)b + 1 || block.previousHash != previousHash) {
+                    throw runtime_error("Ledger blocks out of order");
+                }
+                previousHash = block.hash;
+            }
+            if (!in.expect("EVEND\n") || !in.atEnd()) {
+                throw runtime_error("Checkpoint is truncated");
+            }
+            if (previousHash != headHash) {
+                throw runtime_error("Ledger does not match its recorded head");
+            }
+            auto parseEnd = high_resolution_clock::now();
+            
+            atomic<bool> hashesValid(true);
+            parallelFor(blocks.size(), defaultThreadCount(), [&](int, size_t begin, size_t end) {
+                for (size_t b = begin; b < end && hashesValid.load(memory_order_relaxed); b++) {
+                    if (blocks[b].calculateTransactionsRoot<typename Config::BlockHasher>() != blocks[b].transactionsRoot
+                        || blocks[b].calculateHash<typename Config::BlockHasher>() != blocks[b].hash) {
+                        hashesValid.store(false);
+                    }
+                }
+            });
+            if (!hashesValid.load()) {
+                throw runtime_error("Ledger block hash mismatch");
+            }
+            auto verifyEnd = high_resolution_clock::now();
+            
+            // From here on state is modified; undo it if a check fails
+            try {
+                unsigned char ordinals[InstantRunoffTally::MAX_CANDIDATES];
+                runoff.reserve(voteCount, 1);
+                unsigned long long ledgerVotes = 0;
+                for (size_t b = 0; b < blocks.size(); b++) {
+                    for (size_t i = 0; i < blocks[b].votes.size(); i++) {
+                        int length = ballotOrdinals(blocks[b].votes[i], ordinals);
+                        if (length < 0) {
+                            throw runtime_error("Unknown candidate in ledger");
+                        }
+                        runoff.addBallot(ordinals, length);
+                        ledgerVotes++;
+                    }
+                }
+                if (ledgerVotes != voteCount) {
+                    throw runtime_error("Ledger does not match its recorded vote count");
+                }
+                vector<long long> counts = runoff.firstChoiceCounts();
+                vector<pair<string, int> > tallies;
+                candidates.collectResults(tallies);
+                long long tallied = 0;
+                for (size_t t = 0; t < tallies.size(); t++) {
+                    int ordinal = runoff.ordinalOf(tallies[t].first);
+                    if (ordinal < 0) {
+                        throw runtime_error("Candidate missing from runoff tally");
+                    }
+                    tallies[t].second = (int)counts[ordinal];
+                    tallied += tallies[t].second;
+                }
+                if (tallies != storedTallies) {
+                    throw runtime_error("Tallies do not match the ledger");
+                }
+                auto tallyEnd = high_resolution_clock::now();
+                
+                // Voted flags come from the ledger, then must agree with the stored ones
+                for (size_t i = 0; i < voters.size(); i++) {
+                    voterDB.addLoadedVoter(voters[i].voterID, voters[i].name, false);
+                }
+                for (size_t b = 0; b < blocks.size(); b++) {
+                    for (size_t i = 0; i < blocks[b].votes.size(); i++) {
+                        if (!voterDB.markAsVoted(blocks[b].votes[i].voterID)) {
+                            throw runtime_error("Ledger vote from unknown or repeated voter");
+                        }
+                    }
+                }
+                long long flagged = 0;
+                for (size_t i = 0; i < voters.size(); i++) {
+                    if (voters[i].hasVoted) flagged++;
+                    if (voterDB.findVoter(voters[i].voterID)->hasVoted != voters[i].hasVoted) {
+                        throw runtime_error("Voted flags do not match the ledger");
+                    }
+                }
+                if (flagged != tallied) {
+                    throw runtime_error("Voted flags do not match the tallies");
+                }
+                auto votersEnd = high_resolution_clock::now();
+                
+                for (size_t t = 0; t < tallies.size(); t++) {
+                    candidates.setVoteCount(tallies[t].first, tallies[t].second);
+                }
+                for (size_t b = 0; b < blocks.size(); b++) {
+                    ledger.restoreBlock(blocks[b]);
+                }
+                auto end = high_resolution_clock::now();
+                lastRestore.readSeconds = duration_cast<microseconds>(readEnd - start).count() / 1e6;
+                lastRestore.parseSeconds = duration_cast<microseconds>(parseEnd - readEnd).count() / 1e6;
+                lastRestore.verifySeconds = duration_cast<microseconds>(verifyEnd - parseEnd).count() / 1e6;
+                lastRestore.tallySeconds = duration_cast<microseconds>(tallyEnd - verifyEnd).count() / 1e6;
+                lastRestore.voterSeconds = duration_cast<microseconds>(votersEnd - tallyEnd).count() / 1e6;
+                lastRestore.totalSeconds = duration_cast<microseconds>(end - start).count() / 1e6;
+            } catch (...) {
+                runoff.clearBallots();
+                voterDB.clear();
+                throw;
+            }
+            Log::write(LOG_INFO, "[SUCCESS] Restored {} voters and {} blocks ({} votes) in {.3} s",
+                       voters.size(), blockCount, voteCount, lastRestore.totalSeconds);
+            return true;
+        } catch (const exception& e) {
+            Log::write(LOG_ERROR, "[ERROR] Restore failed: {}", e.what());
+            return false;
+        }
+    }
+    
+    const RestoreTimings& getLastRestoreTimings() const { return lastRestore; }
+};
+
+// Engine presets. Build with -DEVOTING_PRESET=<preset> to select one.
+
+// Original engines: modular hash, linked blocks, DJB2 hashes, candidate BST
+struct ClassicPreset {
+    typedef SimpleVoterHash VoterHash;
+    typedef LinkedBlockStorage LedgerStorage;
+    typedef Djb2BlockHasher BlockHasher;
+    typedef AsyncLogSink LogSink;
+    typedef BasicVoterHashTable<VoterHash, LogSink> VoterStore;
+    typedef BasicCandidateBST<LogSink> TallyEngine;
+    static const char* name() { return "classic"; }
+};
+
+// FNV hashing, chunked block storage and a flat candidate array
+struct FastPreset {
+    typedef FnvVoterHash VoterHash;
+    typedef ChunkedBlockStorage LedgerStorage;
+    typedef Fnv64BlockHasher BlockHasher;
+    typedef AsyncLogSink LogSink;
+    typedef BasicVoterHashTable<VoterHash, LogSink> VoterStore;
+    typedef BasicCandidateArray<LogSink> TallyEngine;
+    static const char* name() { return "fast"; }
+};
+
+// FastPreset with logging compiled out (headless / benchmark builds)
+struct SilentPreset {
+    typedef FnvVoterHash VoterHash;
+    typedef ChunkedBlockStorage LedgerStorage;
+    typedef Fnv64BlockHasher BlockHasher;
+    typedef NullLogSink LogSink;
+    typedef BasicVoterHashTable<VoterHash, LogSink> VoterStore;
+    typedef BasicCandidateArray<LogSink> TallyEngine;
+    static const char* name() { return "silent"; }
+};
+
+#ifndef EVOTING_PRESET
+#define EVOTING_PRESET ClassicPreset
+#endif
+
+typedef BasicVotingSystem<EVOTING_PRESET> VotingSystem;
+
+// ---------------- Admission control ----------------
+// Work reaches the voting system through bounded per-class queues. Each
+// dispatch round serves votes first, then registrations, then a slice of
+// admin work, and deficit round robin gives every class its weighted share
+// of dispatcher time (in microseconds): an audit or a registration burst
+// cannot hold votes up for more than its share of a round, and votes cannot
+// starve the others. A full queue rejects at once with a retry hint rather
+// than growing. Submit and dispatch are called from the thread that owns
+// the VotingSystem, e.g. the event loop of an ingestion front end.
+
+enum WorkClass { WORK_VOTE = 0, WORK_REGISTRATION = 1, WORK_ADMIN = 2, WORK_CLASSES = 3 };
+
+enum AdmissionStatus { ADMITTED, REJECTED_FULL, REJECTED_INVALID };
+
+struct Admission {
+    AdmissionStatus status;
+    long long retryAfterMicros;   // REJECTED_FULL: estimated wait until the queue has room
+    
+    Admission(AdmissionStatus s, long long retry = 0) : status(s), retryAfterMicros(retry) {}
+};
+
+// Fixed-capacity FIFO ring; push fails instead of growing
+template <class T>
+class BoundedQueue {
+private:
+    vector<T> slots;
+    size_t head;
+    size_t count;
+    
+public:
+    BoundedQueue(size_t capacity) : slots(capacity < 1 ? 1 : capacity), head(0), count(0) {}
+    
+    bool push(const T& item) {
+        if (count == slots.size()) return false;
+        slots[(head + count) % slots.size()] = item;
+        count++;
+        return true;
+    }
+    
+    T& front() { return slots[head]; }
+    
+    void pop() {
+        slots[head] = T();
+        head = (head + 1) % slots.size();
+        count--;
+    }
+    
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+    bool empty() const { return count == 0; }
+};
+
+// Latency in 10 us buckets up to 100 ms and 1 ms buckets up to 10 s,
+// plus the exact maximum
+class LatencyHistogram {
+private:
+    static const int FINE_BUCKETS = 10000;
+    static const int BUCKETS = 19900;
+    vector<long long> counts;
+    long long total;
+    long long maxMicros;
+    
+    static int bucketOf(long long micros) {
+        if (micros < FINE_BUCKETS * 10) return (int)(micros / 10);
+        return (int)min<long long>(FINE_BUCKETS + micros / 1000 - FINE_BUCKETS / 100, BUCKETS);
+    }
+    
+    static long long upperEdge(int bucket) {
+        if (bucket < FINE_BUCKETS) return (bucket + 1) * 10LL;
+        return (bucket - FINE_BUCKETS + FINE_BUCKETS / 100 + 1) * 1000LL;
+    }
+    
+public:
+    LatencyHistogram() : counts(BUCKETS + 1, 0), total(0), maxMicros(0) {}
+    
+    void record(long long micros) {
+        if (micros < 0) micros = 0;
+        counts[bucketOf(micros)]++;
+        total++;
+        maxMicros = max(maxMicros, micros);
+    }
+    
+    // Upper edge of the bucket holding the p-th percentile (0-100)
+    long long percentile(double p) const {
+        if (total == 0) return 0;
+        long long rank = (long long)(p / 100.0 * (total - 1)) + 1;
+        long long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen >= rank) return min(maxMicros, upperEdge(i));
+        }
+        return maxMicros;
+    }
+    
+    long long getCount() const { return total; }
+    long long getMax() const { return maxMicros; }
+};
+
+// One queued vote or registration
+struct IngestRequest {
+    InlineText<MAX_VOTER_ID_LENGTH> voterID;
+    InlineText<MAX_VOTER_NAME_LENGTH> text;   // candidate for votes, name for registrations
+    high_resolution_clock::time_point arrivedAt;
+};
+
+// Admission control for front ends that take requests concurrently with
+// admin work. The interactive menu serves one request at a time and waits
+// for each admin task, so it calls the system directly; nothing is ever
+// queued behind it there.
+template <class System>
+class BasicVoteScheduler {
+public:
+    typedef typename System::Log Log;
+    
+    struct ClassStats {
+        long long admitted;
+        long long rejected;
+        long long completed;
+        long long failed;
+        long long busyMicros;
+        LatencyHistogram latency;   // arrival to completion
+        
+        ClassStats() : admitted(0), rejected(0), completed(0), failed(0), busyMicros(0) {}
+    };
+    
+private:
+    static const long long QUANTUM_MICROS = 100;
+    
+    System& system;
+    BoundedQueue<IngestRequest> votes;
+    BoundedQueue<IngestRequest> registrations;
+    BoundedQueue<AdminJob> adminJobs;
+    high_resolution_clock::time_point adminArrivals[8];
+    int weights[WORK_CLASSES];
+    long long deficit[WORK_CLASSES];
+    long long overflow[WORK_CLASSES];   // rejected clients not yet served back
+    double serviceMicros[WORK_CLASSES];   // running average per request (per admin slice)
+    double stepMicros[ADMIN_CHECKPOINT + 1][ADMIN_PHASES];   // running average per admin step, 0 until measured
+    long long adminSliceMicros;
+    ClassStats stats[WORK_CLASSES];
+    
+    size_t queueSize(int workClass) const {
+        if (workClass == WORK_VOTE) return votes.size();
+        if (workClass == WORK_REGISTRATION) return registrations.size();
+        return adminJobs.size();
+    }
+    
+    // Estimated wait at this class's share: half the queue, plus the clients
+    // already told to come back, so a rejected burst returns staggered
+    Admission reject(int workClass) {
+        stats[workClass].rejected++;
+        long long ahead = queueSize(workClass) / 2 + overflow[workClass]++;
+        int totalWeight = weights[WORK_VOTE] + weights[WORK_REGISTRATION] + weights[WORK_ADMIN];
+        double share = (double)weights[workClass] / max(totalWeight, 1);
+        return Admission(REJECTED_FULL, (long long)(ahead * serviceMicros[workClass] / share) + 1);
+    }
+    
+    static void updateAverage(double& average, double micros) {
+        average = (average == 0) ? micros : average * 0.9 + micros * 0.1;
+    }
+    
+    // Serve one request (or one admin slice) of the class; returns the microseconds used
+    long long serveOne(int workClass) {
+        auto start = high_resolution_clock::now();
+        bool done = true;
+        bool ok = true;
+        high_resolution_clock::time_point arrivedAt;
+        if (workClass == WORK_VOTE) {
+            IngestRequest& request = votes.front();
+            ok = system.castVote(request.voterID.view(), request.text.view());
+            arrivedAt = request.arrivedAt;
+            votes.pop();
+        } else if (workClass == WORK_REGISTRATION) {
+            IngestRequest& request = registrations.front();
+            ok = system.registerVoter(request.voterID.view(), request.text.view());
+            arrivedAt = request.arrivedAt;
+            registrations.pop();
+        } else {
+            // Size the slice from what this kind of step has cost so far
+            AdminJob& job = adminJobs.front();
+            long long budget = min(adminSliceMicros, max(deficit[WORK_ADMIN], (long long)QUANTUM_MICROS));
+            double& step = stepMicros[job.task][job.phase];
+            int units = (step == 0) ? 1 : (int)min(1e6, max(1.0, budget / step));
+            done = system.runAdminSlice(job, units);
+            long long micros = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+            updateAverage(step, max((double)micros, 0.5) / units);
+            if (done) {
+                ok = job.ok;
+                arrivedAt = adminArrivals[0];
+                Log::write(LOG_INFO, "[SCHEDULER] Admin {} {} after {} microseconds", adminTaskName(job.task),
+                           ok ? "finished" : "failed",
+                           (long long)duration_cast<microseconds>(high_resolution_clock::now() - arrivedAt).count());
+                for (size_t i = 1; i < sizeof(adminArrivals) / sizeof(adminArrivals[0]); i++) {
+                    adminArrivals[i - 1] = adminArrivals[i];
+                }
+                adminJobs.pop();
+            }
+        }
+        auto end = high_resolution_clock::now();
+        long long micros = duration_cast<microseconds>(end - start).count();
+        updateAverage(serviceMicros[workClass], (double)micros);
+        stats[workClass].busyMicros += micros;
+        if (done) {
+            if (overflow[workClass] > 0) overflow[workClass]--;
+            if (ok) stats[workClass].completed++;
+            else stats[workClass].failed++;
+            stats[workClass].latency.record(duration_cast<microseconds>(end - arrivedAt).count());
+        }
+        return max(micros, 1LL);
+    }
+    
+public:
+    BasicVoteScheduler(System& target, size_t voteCapacity = 4096, size_t registrationCapacity = 1024,
+                       size_t adminCapacity = 4)
+        : system(target), votes(voteCapacity), registrations(registrationCapacity),
+          adminJobs(min(adminCapacity, sizeof(adminArrivals) / sizeof(adminArrivals[0]))),
+          adminSliceMicros(200) {
+        setWeights(8, 3, 1);
+        for (int c = 0; c < WORK_CLASSES; c++) {
+            deficit[c] = 0;
+            overflow[c] = 0;
+            serviceMicros[c] = 5;
+        }
+        for (int t = 0; t <= ADMIN_CHECKPOINT; t++) {
+            for (int p = 0; p < ADMIN_PHASES; p++) stepMicros[t][p] = 0;
+        }
+    }
+    
+    ~BasicVoteScheduler() {
+        if (!adminJobs.empty()) system.cancelAdminJob(adminJobs.front());
+    }
+    
+    // Relative shares of dispatcher time when every class has work queued
+    void setWeights(int vote, int registration, int admin) {
+        weights[WORK_VOTE] = max(vote, 1);
+        weights[WORK_REGISTRATION] = max(registration, 1);
+        weights[WORK_ADMIN] = max(admin, 1);
+    }
+    
+    // Upper bound on one admin step, and so on the delay it adds to a vote
+    void setAdminSliceMicros(long long micros) { adminSliceMicros = max(micros, 1LL); }
+    
+    Admission submitVote(string_view voterID, string_view candidate,
+                         high_resolution_clock::time_point arrivedAt = high_resolution_clock::now()) {
+        if (voterID.size() > MAX_VOTER_ID_LENGTH || candidate.size() > MAX_CANDIDATE_NAME_LENGTH) {
+            stats[WORK_VOTE].rejected++;
+            return Admission(REJECTED_INVALID);
+        }
+        IngestRequest request;
+        request.voterID = InlineText<MAX_VOTER_ID_LENGTH>(voterID);
+        request.text = InlineText<MAX_VOTER_NAME_LENGTH>(candidate);
+        request.arrivedAt = arrivedAt;
+        if (!votes.push(request)) return reject(WORK_VOTE);
+        stats[WORK_VOTE].admitted++;
+        return Admission(ADMITTED);
+    }
+    
+    Admission submitRegistration(string_view voterID, string_view name,
+                                 high_resolution_clock::time_point arrivedAt = high_resolution_clock::now()) {
+        if (!isValidID(voterID) || !isValidName(name)) {
+            stats[WORK_REGISTRATION].rejected++;
+            return Admission(REJECTED_INVALID);
+        }
+        IngestRequest request;
+        request.voterID = InlineText<MAX_VOTER_ID_LENGTH>(voterID);
+        request.text = InlineText<MAX_VOTER_NAME_LENGTH>(name);
+        request.arrivedAt = arrivedAt;
+        if (!registrations.push(request)) return reject(WORK_REGISTRATION);
+        stats[WORK_REGISTRATION].admitted++;
+        return Admission(ADMITTED);
+    }
+    
+    Admission submitAdmin(AdminTask task, const string& target = "",
+                          high_resolution_clock::time_point arrivedAt = high_resolution_clock::now()) {
+        size_t position = adminJobs.size();
+        if (!adminJobs.push(AdminJob(task, target))) return reject(WORK_ADMIN);
+        adminArrivals[position] = arrivedAt;
+        stats[WORK_ADMIN].admitted++;
+        return Admission(ADMITTED);
+    }
+    
+    // One deficit round robin round; false if every queue was empty. A class
+    // that overran its share sits out rounds until its deficit is repaid
+    bool dispatch() {
+        system.sealIfDue();
+        bool pending = false;
+        for (int c = 0; c < WORK_CLASSES; c++) {
+            if (queueSize(c) == 0) {
+                deficit[c] = 0;
+                continue;
+            }
+            pending = true;
+            deficit[c] += weights[c] * QUANTUM_MICROS;
+            while (deficit[c] > 0 && queueSize(c) > 0) {
+                deficit[c] -= serveOne(c);
+            }
+        }
+        return pending;
+    }
+    
+    void drain() {
+        while (dispatch()) {}
+    }
+    
+    size_t getQueued(WorkClass workClass) const { return queueSize(workClass); }
+    const ClassStats& getStats(WorkClass workClass) const { return stats[workClass]; }
+    
+    void displayStats() {
+        const char* labels[] = {"Votes", "Registrations", "Admin jobs"};
+        long long busy = 0;
+        for (int c = 0; c < WORK_CLASSES; c++) busy += stats[c].busyMicros;
+        cout << "\n+========================================+\n";
+        cout << "|     ADMISSION CONTROL STATISTICS       |\n";
+        cout << "+========================================+\n";
+        cout << "  Weights: votes " << weights[WORK_VOTE] << ", registrations " << weights[WORK_REGISTRATION]
+             << ", admin " << weights[WORK_ADMIN] << " | Admin slice: " << adminSliceMicros << " us\n\n";
+        cout << "  " << setw(14) << left << "Class" << right << setw(9) << "Admitted" << setw(9) << "Rejected"
+             << setw(9) << "Done" << setw(7) << "Failed" << setw(9) << "p50 us" << setw(9) << "p99 us"
+             << setw(10) << "max us" << setw(7) << "Busy" << "\n";
+        for (int c = 0; c < WORK_CLASSES; c++) {
+            const ClassStats& st = stats[c];
+            cout << "  " << setw(14) << left << labels[c] << right << setw(9) << st.admitted
+                 << setw(9) << st.rejected << setw(9) << st.completed << setw(7) << st.failed
+                 << setw(9) << st.latency.percentile(50) << setw(9) << st.latency.percentile(99)
+                 << setw(10) << st.latency.getMax() << setw(6) << fixed << setprecision(0)
+                 << (busy > 0 ? st.busyMicros * 100.0 / busy : 0) << "%\n";
+        }
+        cout << left << "\n";
+    }
+};
+
+typedef BasicVoteScheduler<VotingSystem> VoteScheduler;
+
+// Root chain block: anchors the chain head of every shard at one point in time
+struct AnchorBlock {
+    int round;
+    string shardHeads;
+    time_t timestamp;
+    string hash;
+    string previousHash;
+    AnchorBlock* next;
+    
+    AnchorBlock(int r, string heads, string prevHash = "0")
+        : round(r), shardHeads(heads), previousHash(prevHash), next(NULL) {
+        timestamp = time(NULL);
+        hash = calculateHash();
+    }
+    
+    string calculateHash() {
+        stringstream ss;
+        ss << round << shardHeads << timestamp << previousHash;
+        return generateHash(ss.str());
+    }
+};
+
+// Root chain kept by the shard coordinator
+class RootChain {
+private:
+    AnchorBlock* head;
+    AnchorBlock* tail;
+    int anchorCount;
+    
+public:
+    RootChain() : head(NULL), tail(NULL), anchorCount(0) {}
+    
+    void addAnchor(const string& shardHeads) {
+        string prevHash = (tail != NULL) ? tail->hash : "0";
+        AnchorBlock* anchor = new AnchorBlock(anchorCount + 1, shardHeads, prevHash);
+        if (head == NULL) {
+            head = tail = anchor;
+        } else {
+            tail->next = anchor;
+            tail = anchor;
+        }
+        anchorCount++;
+    }
+    
+    bool verifyChain() {
+        AnchorBlock* current = head;
+        while (current != NULL) {
+            if (current->calculateHash() != current->hash) {
+                logAlert("[ALERT] Root anchor #{} has been tampered!", current->round);
+                return false;
+            }
+            if (current->next != NULL && current->hash != current->next->previousHash) {
+                logAlert("[ALERT] Root chain broken after anchor #{}!", current->round);
+                return false;
+            }
+            current = current->next;
+        }
+        return true;
+    }
+    
+    void displayChain() {
+        cout << "\n+========================================+\n";
+        cout << "|       ROOT CHAIN (SHARD ANCHORS)       |\n";
+        cout << "+========================================+\n";
+        AnchorBlock* current = head;
+        while (current != NULL) {
+            cout << "\n+-- Anchor #" << current->round << " ------------------------\n";
+            cout << "| Shard heads: " << current->shardHeads << "\n";
+            cout << "| Hash: " << current->hash << "\n";
+            cout << "| Previous: " << current->previousHash << "\n";
+            cout << "+--------------------------------------\n";
+            current = current->next;
+        }
+        cout << "\nTotal anchors: " << anchorCount << "\n\n";
+    }
+    
+    const AnchorBlock* getTail() const { return tail; }
+    int getAnchorCount() const { return anchorCount; }
+    
+    ~RootChain() {
+        AnchorBlock* current = head;
+        while (current != NULL) {
+            AnchorBlock* toDelete = current;
+            current = current->next;
+            delete toDelete;
+        }
+    }
+};
+
+// Split "a|b|c" into fields
+vector<string> splitFields(const string& line, char sep = '|') {
+    vector<string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t pos = line.find(sep, start);
+        if (pos == string::npos) {
+            fields.push_back(line.substr(start));
+            return fields;
+        }
+        fields.push_back(line.substr(start, pos - start));
+        start = pos + 1;
+    }
+}
+
+// Line-oriented channel over a local socket between coordinator and shard
+class ShardChannel {
+private:
+    int fd;
+    string readBuffer;
+    size_t readPos;
+    
+public:
+    ShardChannel(int f = -1) : fd(f), readPos(0) {}
+    
+    bool sendAll(const string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+    
+    bool readLine(string& line) {
+        while (true) {
+            size_t nl = readBuffer.find('\n', readPos);
+            if (nl != string::npos) {
+                line.assign(readBuffer, readPos, nl - readPos);
+                readPos = nl + 1;
+                if (readPos == readBuffer.size()) {
+                    readBuffer.clear();
+                    readPos = 0;
+                }
+                return true;
+            }
+            if (readPos > 0) {
+                readBuffer.erase(0, readPos);
+                readPos = 0;
+            }
+            char chunk[65536];
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (n == 0) return false;
+            readBuffer.append(chunk, n);
+        }
+    }
+    
+    void closeChannel() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+};
+
+// Shard process main loop. Protocol (one request per line, '|' separated):
+//   B|n      followed by n lines "R|id|name" or "V|id|candidate" -> "B|accepted|rejected"
+//   T        -> "T|registered|voted|candidate|votes|..."
+//   H        -> "H|blocks|headHash"
+//   C|n|hash -> "C|1" if block #n still carries hash, "C|0" otherwise
+//   A        -> "A|1" if the shard ledger verifies, "A|0" otherwise
+//   Q        -> exit
+void runShardWorker(int fd) {
+    // Shard workers only report alerts; the coordinator reports on their behalf
+    AsyncLogger::instance().afterFork();
+    AsyncLogger::instance().setLevel(LOG_ALERT);
+    VotingSystem shard;
+    shard.initializeCandidates();
+    ShardChannel channel(fd);
+    string line;
+    while (channel.readLine(line)) {
+        if (line.empty()) continue;
+        vector<string> fields = splitFields(line);
+        const string& cmd = fields[0];
+        string reply;
+        if (cmd == "B" && fields.size() == 2) {
+            int count = atoi(fields[1].c_str());
+            int accepted = 0;
+            int rejected = 0;
+            for (int i = 0; i < count; i++) {
+                if (!channel.readLine(line)) return;
+                size_t pos1 = line.find('|');
+                size_t pos2 = (pos1 == string::npos) ? string::npos : line.find('|', pos1 + 1);
+                bool ok = false;
+                if (pos2 != string::npos) {
+                    string id = line.substr(pos1 + 1, pos2 - pos1 - 1);
+                    string arg = line.substr(pos2 + 1);
+                    if (line[0] == 'R') ok = shard.registerVoter(id, arg);
+                    else if (line[0] == 'V') ok = shard.castVote(id, arg);
+                }
+                if (ok) accepted++;
+                else rejected++;
+            }
+            stringstream ss;
+            ss << "B|" << accepted << "|" << rejected << "\n";
+            reply = ss.str();
+        } else if (cmd == "T") {
+            vector<pair<string, int> > results;
+            shard.collectResults(results);
+            stringstream ss;
+            ss << "T|" << shard.getTotalVoters() << "|" << shard.getVotedCount();
+            for (size_t i = 0; i < results.size(); i++) {
+                ss << "|" << results[i].first << "|" << results[i].second;
+            }
+            ss << "\n";
+            reply = ss.str();
+        } else if (cmd == "H") {
+            shard.commitLedger();
+            stringstream ss;
+            ss << "H|" << shard.getLedgerBlocks() << "|" << shard.getLedgerHeadHash() << "\n";
+            reply = ss.str();
+        } else if (cmd == "C" && fields.size() == 3) {
+            bool match = shard.getLedgerHashAt(atoi(fields[1].c_str())) == fields[2];
+            reply = match ? "C|1\n" : "C|0\n";
+        } else if (cmd == "A") {
+            reply = shard.verifyLedger() ? "A|1\n" : "A|0\n";
+        } else if (cmd == "Q") {
+            break;
+        } else {
+            reply = "E|unknown command\n";
+        }
+        if (!channel.sendAll(reply)) break;
+    }
+    channel.closeChannel();
+}
+
+// Coordinator for sharded deployment: routes voters to shard processes by
+// hash, merges their tallies and anchors their chain heads into a root chain
+class ShardCoordinator {
+private:
+    struct ShardHandle {
+        pid_t pid;
+        ShardChannel channel;
+        string pendingBatch;
+        int pendingCount;
+        ShardHandle() : pid(-1), pendingCount(0) {}
+    };
+    
+    vector<ShardHandle> shards;
+    RootChain rootChain;
+    int shardCount;
+    bool running;
+    
+    void queueCommand(const string& voterID, const string& command) {
+        ShardHandle& shard = shards[shardForVoter(voterID, shardCount)];
+        shard.pendingBatch += command;
+        shard.pendingCount++;
+    }
+    
+    // Send one request to every shard, then collect the replies
+    bool broadcast(const string& request, vector<vector<string> >& replies) {
+        replies.assign(shardCount, vector<string>());
+        for (int i = 0; i < shardCount; i++) {
+            if (!shards[i].channel.sendAll(request)) return false;
+        }
+        string line;
+        for (int i = 0; i < shardCount; i++) {
+            if (!shards[i].channel.readLine(line)) return false;
+            replies[i] = splitFields(line);
+        }
+        return true;
+    }
+    
+public:
+    ShardCoordinator(int count) : shardCount(count < 1 ? 1 : count), running(false) {}
+    
+    bool start() {
+        cout.flush();
+        logFlush();
+        signal(SIGPIPE, SIG_IGN);
+        shards.resize(shardCount);
+        for (int i = 0; i < shardCount; i++) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                logError("[ERROR] socketpair failed: {}", strerror(errno));
+                stop();
+                return false;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                logError("[ERROR] fork failed: {}", strerror(errno));
+                close(fds[0]);
+                close(fds[1]);
+                stop();
+                return false;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                for (int j = 0; j < i; j++) {
+                    shards[j].channel.closeChannel();
+                }
+                runShardWorker(fds[1]);
+                logFlush();
+                _exit(0);
+            }
+            close(fds[1]);
+            shards[i].pid = pid;
+            shards[i].channel = ShardChannel(fds[0]);
+        }
+        running = true;
+        logInfo("[SHARDS] Started {} shard processes", shardCount);
+        return true;
+    }
+    
+    int getShardCount() const { return shardCount; }
+    
+    void queueRegistration(const string& voterID, const string& name) {
+        queueCommand(voterID, "R|" + voterID + "|" + name + "\n");
+    }
+    
+    void queueVote(const string& voterID, const string& candidate) {
+        queueCommand(voterID, "V|" + voterID + "|" + candidate + "\n");
+    }
+    
+    // Ship queued commands to all shards and wait until every shard applied them
+    bool flushBatches(int& accepted, int& rejected) {
+        for (int i = 0; i < shardCount; i++) {
+            stringstream header;
+            header << "B|" << shards[i].pendingCount << "\n";
+            if (!shards[i].channel.sendAll(header.str() + shards[i].pendingBatch)) return false;
+            shards[i].pendingBatch.clear();
+            shards[i].pendingCount = 0;
+        }
+        string line;
+        for (int i = 0; i < shardCount; i++) {
+            if (!shards[i].channel.readLine(line)) return false;
+            vector<string> fields = splitFields(line);
+            if (fields.size() != 3 || fields[0] != "B") return false;
+            accepted += atoi(fields[1].c_str());
+            rejected += atoi(fields[2].c_str());
+        }
+        return true;
+    }
+    
+    // Record the current chain head of every shard in the root chain
+    bool anchorShardHeads() {
+        vector<vector<string> > replies;
+        if (!broadcast("H\n", replies)) return false;
+        stringstream heads;
+        for (int i = 0; i < shardCount; i++) {
+            if (replies[i].size() != 3 || replies[i][0] != "H" || replies[i][2].empty()) {
+                logAlert("[ALERT] Shard {} returned no valid ledger head", i);
+                return false;
+            }
+            if (i > 0) heads << ";";
+            heads << i << ":" << replies[i][1] << ":" << replies[i][2];
+        }
+        rootChain.addAnchor(heads.str());
+        return true;
+    }
+    
+    // Global audit: root chain, every shard chain, and the latest anchored
+    // heads still present in the shard chains
+    bool auditAll() {
+        bool valid = rootChain.verifyChain();
+        vector<vector<string> > replies;
+        if (!broadcast("A\n", replies)) return false;
+        for (int i = 0; i < shardCount; i++) {
+            if (replies[i].size() != 2 || replies[i][1] != "1") {
+                logAlert("[ALERT] Shard {} ledger failed verification!", i);
+                valid = false;
+            }
+        }
+        const AnchorBlock* latest = rootChain.getTail();
+        if (latest != NULL) {
+            vector<string> entries = splitFields(latest->shardHeads, ';');
+            for (size_t i = 0; i < entries.size(); i++) {
+                vector<string> parts = splitFields(entries[i], ':');
+                if (parts.size() != 3) {
+                    valid = false;
+                    continue;
+                }
+                int shard = atoi(parts[0].c_str());
+                if (shard < 0 || shard >= shardCount) {
+                    valid = false;
+                    continue;
+                }
+                string request = "C|" + parts[1] + "|" + parts[2] + "\n";
+                string line;
+                if (!shards[shard].channel.sendAll(request) || !shards[shard].channel.readLine(line)) {
+                    return false;
+                }
+                if (line != "C|1") {
+                    logAlert("[ALERT] Shard {} no longer contains anchored block #{}!", shard, parts[1]);
+                    valid = false;
+                }
+            }
+        }
+        return valid;
+    }
+    
+    // Merge per-shard tallies into global results
+    bool mergeResults(vector<pair<string, int> >& results, int& registered, int& voted) {
+        vector<vector<string> > replies;
+        if (!broadcast("T\n", replies)) return false;
+        results.clear();
+        registered = 0;
+        voted = 0;
+        for (int i = 0; i < shardCount; i++) {
+            const vector<string>& fields = replies[i];
+            if (fields.size() < 3 || fields[0] != "T") return false;
+            registered += atoi(fields[1].c_str());
+            voted += atoi(fields[2].c_str());
+            for (size_t f = 3; f + 1 < fields.size(); f += 2) {
+                int votes = atoi(fields[f + 1].c_str());
+                size_t k = 0;
+                while (k < results.size() && results[k].first != fields[f]) k++;
+                if (k == results.size()) results.push_back(make_pair(fields[f], 0));
+                results[k].second += votes;
+            }
+        }
+        return true;
+    }
+    
+    void displayResults() {
+        vector<pair<string, int> > results;
+        int registered = 0;
+        int voted = 0;
+        if (!mergeResults(results, registered, voted)) {
+            logError("[ERROR] Failed to collect shard tallies");
+            return;
+        }
+        logFlush();
+        cout << "\n+========================================+\n";
+        cout << "|       MERGED ELECTION RESULTS          |\n";
+        cout << "+========================================+\n";
+        int total = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            cout << "  " << setw(20) << left << results[i].first
+                 << ": " << results[i].second << " votes\n";
+            total += results[i].second;
+        }
+        cout << "\n  Total votes: " << total << "\n";
+        cout << "  Registered: " << registered << " | Voted: " << voted << "\n";
+        cout << "  Shards: " << shardCount << " | Root anchors: " << rootChain.getAnchorCount() << "\n\n";
+    }
+    
+    void displayRootChain() { rootChain.displayChain(); }
+    
+    void stop() {
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (running) shards[i].channel.sendAll("Q\n");
+            shards[i].channel.closeChannel();
+        }
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (shards[i].pid > 0) waitpid(shards[i].pid, NULL, 0);
+            shards[i].pid = -1;
+        }
+        running = false;
+    }
+    
+    ~ShardCoordinator() {
+        stop();
+    }
+};
+
+// Throughput of one sharded run, for the --shards sweep
+struct ShardRunStats {
+    double registrationsPerSecond;
+    double votesPerSecond;
+    bool valid;
+    
+    ShardRunStats() : registrationsPerSecond(0), votesPerSecond(0), valid(false) {}
+};
+
+// Sharded load run: registers and votes `voterCount` voters across the shards
+int runShardedElection(int shardCount, int voterCount, ShardRunStats* runStats = NULL) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    const int BATCH_SIZE = 4096;
+    const int ANCHOR_EVERY = 16;
+    
+    ShardCoordinator coordinator(shardCount);
+    if (!coordinator.start()) return 1;
+    
+    int accepted = 0;
+    int rejected = 0;
+    auto regStart = high_resolution_clock::now();
+    for (int i = 0; i < voterCount; i++) {
+        stringstream id;
+        id << "S" << setw(7) << setfill('0') << i;
+        coordinator.queueRegistration(id.str(), "Voter " + id.str());
+        if ((i + 1) % BATCH_SIZE == 0 && !coordinator.flushBatches(accepted, rejected)) {
+            logError("[ERROR] Shard communication failed");
+            return 1;
+        }
+    }
+    if (!coordinator.flushBatches(accepted, rejected)) return 1;
+    auto regEnd = high_resolution_clock::now();
+    logInfo("[SHARDS] Registered {} voters ({} rejected)", accepted, rejected);
+    
+    accepted = 0;
+    rejected = 0;
+    int batches = 0;
+    auto voteStart = high_resolution_clock::now();
+    for (int i = 0; i < voterCount; i++) {
+        stringstream id;
+        id << "S" << setw(7) << setfill('0') << i;
+        coordinator.queueVote(id.str(), names[i % 4]);
+        if ((i + 1) % BATCH_SIZE == 0) {
+            if (!coordinator.flushBatches(accepted, rejected)) return 1;
+            if (++batches % ANCHOR_EVERY == 0 && !coordinator.anchorShardHeads()) {
+                logAlert("[ALERT] Could not anchor shard heads after {} votes; stopping election", i + 1);
+                return 2;
+            }
+        }
+    }
+    if (!coordinator.flushBatches(accepted, rejected)) return 1;
+    if (!coordinator.anchorShardHeads()) {
+        logAlert("[ALERT] Could not anchor final shard heads; stopping election");
+        return 2;
+    }
+    auto voteEnd = high_resolution_clock::now();
+    
+    double regSeconds = duration_cast<microseconds>(regEnd - regStart).count() / 1e6;
+    double voteSeconds = duration_cast<microseconds>(voteEnd - voteStart).count() / 1e6;
+    logInfo("[SHARDS] Cast {} votes ({} rejected)\n"
+            "         [TIME] Registration: {.3} s ({.0} ops/s)\n"
+            "         [TIME] Voting: {.3} s ({.0} votes/s)",
+            accepted, rejected, regSeconds, regSeconds > 0 ? voterCount / regSeconds : 0.0,
+            voteSeconds, voteSeconds > 0 ? accepted / voteSeconds : 0.0);
+    
+    coordinator.displayResults();
+    auto auditStart = high_resolution_clock::now();
+    bool valid = coordinator.auditAll();
+    auto auditEnd = high_resolution_clock::now();
+    logInfo("[AUDIT] Global audit: {}\n        [TIME] {} microseconds",
+            valid ? "VALID" : "COMPROMISED",
+            (long long)duration_cast<microseconds>(auditEnd - auditStart).count());
+    coordinator.stop();
+    if (runStats != NULL) {
+        runStats->registrationsPerSecond = regSeconds > 0 ? voterCount / regSeconds : 0.0;
+        runStats->votesPerSecond = voteSeconds > 0 ? accepted / voteSeconds : 0.0;
+        runStats->valid = valid;
+    }
+    return valid ? 0 : 2;
+}
+
+// Run the same election for each shard count and compare throughput. Shards
+// are processes, so they can only scale up to the number of cores
+int runShardSweep(const vector<int>& shardCounts, int voterCount) {
+    vector<ShardRunStats> runs(shardCounts.size());
+    for (size_t i = 0; i < shardCounts.size(); i++) {
+        logInfo("\n[SHARDS] Sweep run {}/{}: {} shard(s)", (int)i + 1, (int)shardCounts.size(), shardCounts[i]);
+        int status = runShardedElection(shardCounts[i], voterCount, &runs[i]);
+        if (status == 1) return 1;
+    }
+    logFlush();
+    
+    cout << "\n+========================================+\n";
+    cout << "|        SHARD SCALING SWEEP             |\n";
+    cout << "+========================================+\n";
+    cout << "  Voters: " << voterCount << " | Cores: " << defaultThreadCount() << "\n\n";
+    cout << "  " << setw(8) << left << "Shards" << setw(14) << right << "Register/s"
+         << setw(14) << "Votes/s" << setw(10) << "Speedup" << setw(10) << "Audit" << "\n";
+    bool valid = true;
+    double baseline = runs[0].votesPerSecond;
+    for (size_t i = 0; i < runs.size(); i++) {
+        cout << "  " << setw(8) << left << shardCounts[i] << right << fixed << setprecision(0)
+             << setw(14) << runs[i].registrationsPerSecond << setw(14) << runs[i].votesPerSecond
+             << setprecision(2) << setw(9) << (baseline > 0 ? runs[i].votesPerSecond / baseline : 0.0) << "x"
+             << setw(10) << (runs[i].valid ? "VALID" : "FAILED") << "\n";
+        valid = valid && runs[i].valid;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    
+    // Scaling means vote throughput grows with the shard count; report it
+    // against the first run rather than assume it
+    size_t widest = 0;
+    for (size_t i = 1; i < runs.size(); i++) {
+        if (shardCounts[i] > shardCounts[widest]) widest = i;
+    }
+    double speedup = baseline > 0 ? runs[widest].votesPerSecond / baseline : 0.0;
+    double shardRatio = (double)shardCounts[widest] / shardCounts[0];
+    cout << "\n  Scaling: " << shardCounts[widest] << " shards vote at " << fixed << setprecision(2)
+         << speedup << "x the rate of " << shardCounts[0] << " (" << shardRatio << "x the shards)";
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    if (shardRatio <= 1.0) {
+        cout << "\n";
+    } else if (speedup >= 1.0 + (shardRatio - 1.0) / 2) {
+        cout << " - scales\n";
+    } else {
+        cout << " - does not scale";
+        if (defaultThreadCount() < shardCounts[widest]) cout << " (more shards than cores)";
+        cout << "\n";
+    }
+    cout << "  Status: " << (valid ? "OK" : "FAILED (a global audit failed)") << "\n\n";
+    return valid ? 0 : 2;
+}
+
+void showBanner() {
+    cout << "\n";
+    cout << "+========================================+\n";
+    cout << "|                                        |\n";
+    cout << "|     SECURE E-VOTING SYSTEM             |\n";
+    cout << "|                                        |\n";
+    cout << "|   Blockchain - Hash Table - BST        |\n";
+    cout << "|   WITH TIME COMPLEXITY ANALYSIS        |\n";
+    cout << "|                                        |\n";
+    cout << "+========================================+\n";
+}
+
+void showMenu() {
+    cout << "\n+========================================+\n";
+    cout << "|          MAIN MENU                     |\n";
+    cout << "+========================================+\n";
+    cout << "| VOTER OPERATIONS:                      |\n";
+    cout << "|  1. Register New Voter                 |\n";
+    cout << "|  2. Cast Vote (with timing)            |\n";
+    cout << "|  3. View Election Results              |\n";
+    cout << "|  4. View Vote Percentages              |\n";
+    cout << "|  5. View Registered Voters             |\n";
+    cout << "| 18. Search Voters by ID / Name         |\n";
+    cout << "|                                        |\n";
+    cout << "| BLOCKCHAIN & SECURITY:                 |\n";
+    cout << "|  6. View Blockchain Ledger             |\n";
+    cout << "|  7. Audit Blockchain Security          |\n";
+    cout << "|                                        |\n";
+    cout << "| ADMIN & ANALYSIS:                      |\n";
+    cout << "|  8. Admin Dashboard                    |\n";
+    cout << "|  9. Hash Table Statistics              |\n";
+    cout << "| 10. Time Complexity Analysis           |\n";
+    cout << "|                                        |\n";
+    cout << "| FILE OPERATIONS:                       |\n";
+    cout << "| 11. Save Data                          |\n";
+    cout << "| 12. Load Data                          |\n";
+    cout << "|                                        |\n";
+    cout << "| RANKED-CHOICE:                         |\n";
+    cout << "| 13. Cast Ranked Vote                   |\n";
+    cout << "| 14. Instant-Runoff Results             |\n";
+    cout << "|                                        |\n";
+    cout << "| EXPORT & CHECKPOINT:                   |\n";
+    cout << "| 15. Export Results & Ledger            |\n";
+    cout << "| 16. Checkpoint System State            |\n";
+    cout << "|                                        |\n";
+    cout << "| HISTORY:                               |\n";
+    cout << "| 17. Results at Block / Time            |\n";
+    cout << "|                                        |\n";
+    cout << "|  0. Exit                               |\n";
+    cout << "+========================================+\n";
+    cout << "\nEnter choice: ";
+}
+
+// input handling. Votes left pending at the prompt are sealed when their
+// block time runs out, not when the next choice is entered
+int getMenuChoice(VotingSystem& system) {
+    int wait;
+    while ((wait = system.millisUntilSeal()) >= 0) {
+        struct pollfd input;
+        input.fd = STDIN_FILENO;
+        input.events = POLLIN;
+        if (poll(&input, 1, wait) != 0) break;
+        system.sealIfDue();
+    }
+    int choice;
+    while (true) {
+        if (cin >> choice) {
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear entire buffer
+            return choice;
+        } else {
+            cin.clear();  // Clear error flags
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard bad input
+            cout << "[ERROR] Invalid input! Please enter a number: ";
+        }
+    }
+}
+
+// Ledger throughput and verification cost for several block sizes
+int runLedgerBenchmark(int voteCount) {
+    const int blockSizes[] = {1, 8, 64, 512, 4096};
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    vector<string> voterIDs(voteCount);
+    for (int i = 0; i < voteCount; i++) {
+        stringstream id;
+        id << "L" << setw(7) << setfill('0') << i;
+        voterIDs[i] = id.str();
+    }
+    
+    cout << "\n+========================================+\n";
+    cout << "|     LEDGER BLOCK SIZE BENCHMARK        |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << "\n";
+    cout << "  Votes per run: " << voteCount << "\n\n";
+    cout << "  " << setw(6) << right << "K" << setw(10) << "Blocks" << setw(14) << "Votes/s"
+         << setw(14) << "Verify ms" << setw(14) << "ns/vote" << "\n";
+    for (size_t s = 0; s < sizeof(blockSizes) / sizeof(blockSizes[0]); s++) {
+        VotingSystem::Ledger ledger(blockSizes[s], 0);
+        // Per-vote status lines would dominate the measurement
+        LogLevel previousLevel = AsyncLogger::instance().getLevel();
+        AsyncLogger::instance().setLevel(LOG_WARN);
+        auto addStart = high_resolution_clock::now();
+        for (int i = 0; i < voteCount; i++) {
+            ledger.addVote(voterIDs[i], names[i % 4]);
+        }
+        ledger.commitPending();
+        auto addEnd = high_resolution_clock::now();
+        bool valid = ledger.verifyChain();
+        auto verifyEnd = high_resolution_clock::now();
+        AsyncLogger::instance().setLevel(previousLevel);
+        
+        double addSeconds = duration_cast<nanoseconds>(addEnd - addStart).count() / 1e9;
+        double verifyNs = (double)duration_cast<nanoseconds>(verifyEnd - addEnd).count();
+        cout << "  " << setw(6) << right << blockSizes[s] << setw(10) << ledger.getBlockCount()
+             << setw(14) << fixed << setprecision(0) << (addSeconds > 0 ? voteCount / addSeconds : 0)
+             << setw(14) << setprecision(2) << verifyNs / 1e6
+             << setw(14) << setprecision(1) << (voteCount > 0 ? verifyNs / voteCount : 0)
+             << (valid ? "" : "  INVALID") << "\n";
+    }
+    cout << left << "\n";
+    return 0;
+}
+
+// Instant-runoff tabulation over synthetic ranked ballots
+int runRunoffBenchmark(long long ballotCount) {
+    const char* names[] = {"Akram", "Kashan", "Mubashir", "Suleman", "Zainab", "Hira"};
+    const int candidateCount = 6;
+    InstantRunoffTally tally;
+    for (int c = 0; c < candidateCount; c++) {
+        tally.addCandidate(names[c]);
+    }
+    tally.reserve(ballotCount, candidateCount);
+    
+    // Skewed random rankings of 1..6 preferences (xorshift, fixed seed)
+    auto genStart = high_resolution_clock::now();
+    unsigned long long state = 88172645463325252ull;
+    unsigned char ballot[6];
+    for (long long b = 0; b < ballotCount; b++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        unsigned long long bits = state;
+        unsigned char order[6] = {0, 1, 2, 3, 4, 5};
+        for (int i = 0; i < candidateCount; i++) {
+            int span = candidateCount - i;
+            int pick = i + (int)((bits & 0xff) * (bits & 0xff) / (256 * 256 / span + 1)) % span;
+            bits >>= 8;
+            swap(order[i], order[pick]);
+            ballot[i] = order[i];
+        }
+        int length = 1 + (int)(bits % candidateCount);
+        tally.addBallot(ballot, length);
+    }
+    auto genEnd = high_resolution_clock::now();
+    logInfo("[RUNOFF] Generated {} ballots in {.3} s", ballotCount,
+            duration_cast<microseconds>(genEnd - genStart).count() / 1e6);
+    logFlush();
+    
+    InstantRunoffTally::Result result = tally.tabulate();
+    tally.displayRounds(result);
+    return result.winner >= 0 ? 0 : 2;
+}
+
+// End-to-end throughput of the compiled-in engine preset
+int runSystemBenchmark(int voterCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    vector<string> voterIDs(voterCount);
+    for (int i = 0; i < voterCount; i++) {
+        stringstream id;
+        id << "P" << setw(7) << setfill('0') << i;
+        voterIDs[i] = id.str();
+    }
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    VotingSystem system;
+    system.initializeCandidates();
+    
+    auto regStart = high_resolution_clock::now();
+    for (int i = 0; i < voterCount; i++) {
+        system.registerVoter(voterIDs[i], "Voter " + voterIDs[i]);
+    }
+    auto voteStart = high_resolution_clock::now();
+    for (int i = 0; i < voterCount; i++) {
+        system.castVote(voterIDs[i], names[i % 4]);
+    }
+    system.commitLedger();
+    auto voteEnd = high_resolution_clock::now();
+    bool valid = system.verifyLedger();
+    auto verifyEnd = high_resolution_clock::now();
+    logFlush();
+    
+    double regSeconds = duration_cast<nanoseconds>(voteStart - regStart).count() / 1e9;
+    double voteSeconds = duration_cast<nanoseconds>(voteEnd - voteStart).count() / 1e9;
+    double verifyMs = duration_cast<nanoseconds>(verifyEnd - voteEnd).count() / 1e6;
+    cout << "\n+========================================+\n";
+    cout << "|     ENGINE PRESET BENCHMARK            |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << "\n";
+    cout << "  Voters: " << voterCount << "\n";
+    cout << "  Registration: " << fixed << setprecision(0)
+         << (regSeconds > 0 ? voterCount / regSeconds : 0) << " ops/s\n";
+    cout << "  Voting: " << (voteSeconds > 0 ? system.getVotedCount() / voteSeconds : 0) << " votes/s\n";
+    cout << "  Verification: " << setprecision(2) << verifyMs << " ms ("
+         << (valid ? "VALID" : "INVALID") << ")\n\n";
+    return valid ? 0 : 2;
+}
+
+// Counts heap allocations per castVote once the system is warmed up. Every
+// vote counts: ordinary votes must not allocate at all, and a vote that
+// seals a block may allocate only for the block itself (its vote array, its
+// three hash strings, storage and the occasional tally checkpoint), at most
+// SEAL_ALLOCATION_BUDGET on average. The amortized figure covers all votes.
+#ifdef EVOTING_ALLOC_CHECK
+int runAllocationCheck(int voterCount) {
+    const double SEAL_ALLOCATION_BUDGET = 8;
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    vector<string> voterIDs(voterCount);
+    for (int i = 0; i < voterCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "A%07d", i);
+        voterIDs[i] = id;
+    }
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    VotingSystem system;
+    system.initializeCandidates();
+    for (int i = 0; i < voterCount; i++) {
+        system.registerVoter(voterIDs[i], "Voter " + voterIDs[i]);
+    }
+    system.reserveBallots(voterCount);
+    
+    long long votesChecked = 0;
+    long long allocatingVotes = 0;
+    unsigned long long voteAllocations = 0;
+    long long sealingVotes = 0;
+    unsigned long long sealAllocations = 0;
+    unsigned long long maxSealAllocations = 0;
+    int firstAllocating = -1;
+    // Vote 0 warms up the logger ring and the first pending block, and the
+    // first seal sizes the reusable hash buffers
+    for (int i = 0; i < voterCount; i++) {
+        int blocksBefore = system.getLedgerBlocks();
+        unsigned long long before = allocationCount;
+        system.castVote(voterIDs[i], names[i % 4]);
+        unsigned long long used = allocationCount - before;
+        if (i == 0) continue;
+        bool sealed = system.getLedgerBlocks() != blocksBefore;
+        if (sealed && blocksBefore == 0) continue;
+        votesChecked++;
+        if (sealed) {
+            sealingVotes++;
+            sealAllocations += used;
+            maxSealAllocations = max(maxSealAllocations, used);
+        } else if (used > 0) {
+            allocatingVotes++;
+            voteAllocations += used;
+            if (firstAllocating < 0) firstAllocating = i;
+        }
+    }
+    logFlush();
+    
+    double perSeal = sealingVotes > 0 ? (double)sealAllocations / sealingVotes : 0.0;
+    double perVote = votesChecked > 0 ? (double)(voteAllocations + sealAllocations) / votesChecked : 0.0;
+    bool pass = allocatingVotes == 0 && perSeal <= SEAL_ALLOCATION_BUDGET;
+    cout << "\n+========================================+\n";
+    cout << "|     VOTE PATH ALLOCATION CHECK         |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << "\n";
+    cout << "  Votes checked: " << votesChecked << " (" << sealingVotes << " sealed a block)\n";
+    cout << "  Non-sealing votes that allocated: " << allocatingVotes << " (" << voteAllocations << " allocations)\n";
+    if (firstAllocating >= 0) {
+        cout << "  First allocating vote: #" << firstAllocating << "\n";
+    }
+    cout << "  Block-sealing votes: " << fixed << setprecision(1) << perSeal << " allocations each (max "
+         << maxSealAllocations << ", budget " << SEAL_ALLOCATION_BUDGET << ")\n";
+    cout << "  Amortized over all votes: " << setprecision(3) << perVote << " allocations per vote\n";
+    cout << "  Result: " << (pass ? "PASS" : "FAIL") << "\n\n";
+    return pass ? 0 : 2;
+}
+#else
+int runAllocationCheck(int) {
+    cout << "--alloc-check needs a build with -DEVOTING_ALLOC_CHECK (counting operator new)\n";
+    return 1;
+}
+#endif
+
+// Vote latency before and while a checkpoint is being written, then a
+// restore of that checkpoint compared against the state it captured
+int runSnapshotBenchmark(int voterCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    const string path = "snapshot_bench.ckpt";
+    vector<string> voterIDs(voterCount);
+    for (int i = 0; i < voterCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "S%07d", i);
+        voterIDs[i] = id;
+    }
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    VotingSystem system;
+    system.initializeCandidates();
+    for (int i = 0; i < voterCount; i++) {
+        system.registerVoter(voterIDs[i], "Voter " + voterIDs[i]);
+    }
+    system.reserveBallots(voterCount);
+    
+    vector<long long> before, during, after;
+    before.reserve(voterCount / 2);
+    during.reserve(voterCount);
+    int half = voterCount / 2;
+    for (int i = 0; i < half; i++) {
+        auto start = high_resolution_clock::now();
+        system.castVote(voterIDs[i], names[i % 4]);
+        before.push_back(duration_cast<nanoseconds>(high_resolution_clock::now() - start).count());
+    }
+    
+    auto pauseStart = high_resolution_clock::now();
+    bool started = system.startCheckpoint(path);
+    auto pauseEnd = high_resolution_clock::now();
+    vector<pair<string, int> > expectedTallies;
+    system.collectResults(expectedTallies);
+    string expectedHead = system.getLedgerHeadHash();
+    int expectedVoted = system.getVotedCount();
+    
+    for (int i = half; i < voterCount; i++) {
+        bool inFlight = system.isCheckpointRunning();
+        auto start = high_resolution_clock::now();
+        system.castVote(voterIDs[i], names[i % 4]);
+        long long ns = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+        (inFlight ? during : after).push_back(ns);
+    }
+    bool saved = started && system.finishCheckpoint();
+    
+    VotingSystem restored;
+    restored.initializeCandidates();
+    bool loaded = saved && restored.restoreCheckpoint(path);
+    vector<pair<string, int> > restoredTallies;
+    restored.collectResults(restoredTallies);
+    bool match = loaded && restoredTallies == expectedTallies
+                 && restored.getLedgerHeadHash() == expectedHead
+                 && restored.getVotedCount() == expectedVoted
+                 && restored.verifyLedger();
+    remove(path.c_str());
+    logFlush();
+    
+    cout << "\n+========================================+\n";
+    cout << "|     SNAPSHOT LATENCY BENCHMARK         |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << "\n";
+    cout << "  Voters: " << voterCount << " (checkpoint after " << half << " votes)\n";
+    cout << "  Fork pause: " << fixed << setprecision(3)
+         << duration_cast<microseconds>(pauseEnd - pauseStart).count() / 1000.0 << " ms\n";
+    cout << "  Checkpoint written in: " << system.getLastCheckpointMicros() / 1000.0 << " ms\n\n";
+    cout << "  " << setw(18) << left << "Vote latency (us)" << right << setw(10) << "Votes"
+         << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "max" << "\n";
+    vector<long long>* phases[] = {&before, &during, &after};
+    const char* labels[] = {"before", "during", "after"};
+    for (int p = 0; p < 3; p++) {
+        vector<long long>& samples = *phases[p];
+        sort(samples.begin(), samples.end());
+        cout << "  " << setw(18) << left << labels[p] << right << setw(10) << samples.size();
+        if (samples.empty()) {
+            cout << "\n";
+            continue;
+        }
+        cout << setprecision(2) << setw(10) << samples[samples.size() / 2] / 1000.0
+             << setw(10) << samples[samples.size() * 99 / 100] / 1000.0
+             << setw(10) << samples.back() / 1000.0 << "\n";
+    }
+    cout << left << "\n  Restore: " << (match ? "MATCH (tallies, ledger head, voted flags)" : "MISMATCH") << "\n\n";
+    return match ? 0 : 2;
+}
+
+// Startup recovery: checkpoint an election of voteCount votes, drop it, and
+// time the restore that rebuilds tallies and voted flags from the ledger
+int runRecoveryBenchmark(int voteCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    const string path = "recovery_bench.ckpt";
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    vector<pair<string, int> > expectedTallies;
+    string expectedHead;
+    int expectedVoted = 0;
+    bool saved = false;
+    auto buildStart = high_resolution_clock::now();
+    {
+        VotingSystem system;
+        system.initializeCandidates();
+        system.reserveBallots(voteCount);
+        char id[16];
+        for (int i = 0; i < voteCount; i++) {
+            snprintf(id, sizeof(id), "R%09d", i);
+            system.registerVoter(id, "Voter");
+        }
+        for (int i = 0; i < voteCount; i++) {
+            snprintf(id, sizeof(id), "R%09d", i);
+            // Skewed so every candidate ends with a different count
+            system.castVote(id, names[(i % 10) < 4 ? 0 : (i % 10) < 7 ? 1 : (i % 10) < 9 ? 2 : 3]);
+        }
+        saved = system.startCheckpoint(path) && system.finishCheckpoint();
+        system.collectResults(expectedTallies);
+        expectedHead = system.getLedgerHeadHash();
+        expectedVoted = system.getVotedCount();
+    }
+    auto buildEnd = high_resolution_clock::now();
+    
+    VotingSystem restored;
+    restored.initializeCandidates();
+    bool loaded = saved && restored.restoreCheckpoint(path);
+    vector<pair<string, int> > restoredTallies;
+    restored.collectResults(restoredTallies);
+    bool match = loaded && restoredTallies == expectedTallies
+                 && restored.getLedgerHeadHash() == expectedHead
+                 && restored.getVotedCount() == expectedVoted;
+    remove(path.c_str());
+    logFlush();
+    
+    const RestoreTimings& timings = restored.getLastRestoreTimings();
+    cout << "\n+========================================+\n";
+    cout << "|     STARTUP RECOVERY BENCHMARK         |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << " | Threads: " << defaultThreadCount() << "\n";
+    cout << "  Votes: " << voteCount << " in " << restored.getLedgerBlocks() << " blocks\n";
+    cout << "  Election + checkpoint: " << fixed << setprecision(3)
+         << duration_cast<microseconds>(buildEnd - buildStart).count() / 1e6 << " s\n\n";
+    cout << "  Read checkpoint:       " << timings.readSeconds << " s\n";
+    cout << "  Parse voters + blocks: " << timings.parseSeconds << " s\n";
+    cout << "  Verify block hashes:   " << timings.verifySeconds << " s (parallel)\n";
+    cout << "  Rebuild tallies:       " << timings.tallySeconds << " s (parallel histogram)\n";
+    cout << "  Rebuild voted flags:   " << timings.voterSeconds << " s\n";
+    cout << "  Total recovery:        " << timings.totalSeconds << " s ("
+         << setprecision(0) << (timings.totalSeconds > 0 ? voteCount / timings.totalSeconds : 0)
+         << " votes/s)\n";
+    for (size_t i = 0; i < restoredTallies.size(); i++) {
+        cout << "    " << setw(20) << left << restoredTallies[i].first << restoredTallies[i].second << "\n";
+    }
+    cout << "\n  Rebuilt state: " << (match ? "MATCH" : "MISMATCH") << "\n\n";
+    return match ? 0 : 2;
+}
+
+// Export throughput against a plain fwrite of the same number of bytes
+int runExportBenchmark(int blockCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    VotingSystem::Ledger ledger(1, 0);
+    ExportSnapshot snapshot;
+    for (int c = 0; c < 4; c++) {
+        snapshot.candidateNames.push_back(names[c]);
+        snapshot.tallies.push_back(make_pair(names[c], 0));
+    }
+    snapshot.turnout.reserve(blockCount);
+    auto buildStart = high_resolution_clock::now();
+    for (int i = 0; i < blockCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "X%08d", i);
+        ledger.addVote(id, names[i % 4], (i % 3 == 0) ? names[i % 4] + ">" + names[(i + 1) % 4] : "");
+        snapshot.tallies[i % 4].second++;
+        snapshot.turnout.push_back(make_pair(string(id), true));
+    }
+    ledger.commitPending();
+    auto buildEnd = high_resolution_clock::now();
+    snapshot.firstBlock = ledger.getFirstBlock();
+    snapshot.blockCount = ledger.getBlockCount();
+    snapshot.voteCount = ledger.getTotalVotes();
+    
+    ResultExporter exporter;
+    ResultExporter::Stats stats = exporter.exportAll(snapshot, "election_bench");
+    
+    // Disk baseline: the same byte count through the same buffered stdio path
+    long long totalBytes = stats.csvBytes + stats.binaryBytes;
+    string block(1 << 20, 'x');
+    auto rawStart = high_resolution_clock::now();
+    FILE* raw = fopen("election_bench_raw.bin", "wb");
+    bool rawOk = raw != NULL;
+    for (long long written = 0; rawOk && written < totalBytes; written += block.size()) {
+        size_t len = (size_t)min<long long>(block.size(), totalBytes - written);
+        rawOk = fwrite(block.data(), 1, len, raw) == len;
+    }
+    if (raw != NULL) rawOk = (fclose(raw) == 0) && rawOk;
+    auto rawEnd = high_resolution_clock::now();
+    remove("election_bench_raw.bin");
+    const char* outputs[] = {"_ledger.csv", "_ledger.evc", "_tallies.csv", "_turnout.csv"};
+    for (const char* suffix : outputs) {
+        remove((string("election_bench") + suffix).c_str());
+    }
+    logFlush();
+    
+    double rawSeconds = duration_cast<microseconds>(rawEnd - rawStart).count() / 1e6;
+    double exportMBs = stats.seconds > 0 ? totalBytes / 1e6 / stats.seconds : 0;
+    double rawMBs = rawSeconds > 0 ? totalBytes / 1e6 / rawSeconds : 0;
+    cout << "\n+========================================+\n";
+    cout << "|     EXPORT BENCHMARK                   |\n";
+    cout << "+========================================+\n";
+    cout << "  Blocks: " << stats.blocks << " (" << stats.votes << " votes)\n";
+    cout << "  Ledger build: " << fixed << setprecision(3)
+         << duration_cast<microseconds>(buildEnd - buildStart).count() / 1e6 << " s\n";
+    cout << "  CSV bytes: " << stats.csvBytes << "\n";
+    cout << "  Columnar bytes: " << stats.binaryBytes << " ("
+         << setprecision(1) << (stats.csvBytes > 0 ? stats.binaryBytes * 100.0 / stats.csvBytes : 0)
+         << "% of CSV)\n";
+    cout << "  Export: " << setprecision(3) << stats.seconds << " s, "
+         << setprecision(1) << exportMBs << " MB/s\n";
+    cout << "  Raw write: " << setprecision(3) << rawSeconds << " s, "
+         << setprecision(1) << rawMBs << " MB/s\n";
+    cout << "  Export / raw: " << setprecision(2) << (rawMBs > 0 ? exportMBs / rawMBs : 0) << "x\n";
+    cout << "  Disk-speed target: " << (exportMBs >= rawMBs * 0.8 ? "met" : "NOT MET")
+         << " (export is bound by encoding on " << defaultThreadCount()
+         << " core(s); the raw write mostly measures the page cache)\n";
+    cout << "  Status: " << (stats.success && rawOk ? "OK" : "FAILED") << "\n\n";
+    return stats.success && rawOk ? 0 : 2;
+}
+
+// Registrar search: prefix queries over voterCount voters against a linear scan
+int runSearchBenchmark(int voterCount) {
+    const char* firstNames[] = {"Abbad", "Talal", "Haziq", "Ayesha", "Zainab", "Hira", "Omar", "Bilal",
+                                "Sana", "Fatima", "Usman", "Hamza", "Maryam", "Ali", "Noor", "Saad"};
+    const char* lastNames[] = {"Ahmed", "Khan", "Ali", "Butt", "Malik", "Sheikh", "Qureshi", "Raza",
+                               "Iqbal", "Hussain", "Chaudhry", "Mirza", "Siddiqui", "Javed", "Aslam", "Bokhari"};
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    vector<string> voterIDs(voterCount);
+    vector<string> voterNames(voterCount);
+    for (int i = 0; i < voterCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "S%08d", i);
+        voterIDs[i] = id;
+        voterNames[i] = string(firstNames[i % 16]) + " " + lastNames[(i / 16) % 16] + " " + to_string(i / 256);
+    }
+    VotingSystem system;
+    auto registerStart = high_resolution_clock::now();
+    for (int i = 0; i < voterCount; i++) {
+        system.registerVoter(voterIDs[i], voterNames[i]);
+    }
+    auto registerEnd = high_resolution_clock::now();
+    vector<const Voter*> page;
+    auto buildStart = high_resolution_clock::now();
+    system.searchVoters(false, "", 0, 1, page);
+    system.searchVoters(true, "", 0, 1, page);
+    auto buildEnd = high_resolution_clock::now();
+    
+    // Prefixes cut from random existing IDs and names, in random case (xorshift, fixed seed)
+    const int queryCount = 20000;
+    unsigned long long state = 88172645463325252ull;
+    vector<pair<bool, string> > queries(queryCount);
+    for (int q = 0; q < queryCount && voterCount > 0; q++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        bool byName = (q % 2) == 1;
+        const string& source = byName ? voterNames[state % voterCount] : voterIDs[state % voterCount];
+        string prefix = source.substr(0, 1 + (state >> 32) % min<size_t>(source.size(), 10));
+        for (size_t c = 0; c < prefix.size(); c++) {
+            if ((state >> (40 + c % 20)) & 1) prefix[c] = toupper((unsigned char)prefix[c]);
+            else prefix[c] = tolower((unsigned char)prefix[c]);
+        }
+        queries[q] = make_pair(byName, prefix);
+    }
+    const size_t pageSize = 20;
+    vector<long long> firstPage, laterPage;
+    vector<size_t> totals(queries.size());
+    for (int pass = 0; pass < 2; pass++) {
+        vector<long long>& samples = (pass == 0) ? firstPage : laterPage;
+        for (size_t q = 0; q < queries.size(); q++) {
+            page.clear();
+            auto start = high_resolution_clock::now();
+            totals[q] = system.searchVoters(queries[q].first, queries[q].second, pass * 10 * pageSize, pageSize, page);
+            auto end = high_resolution_clock::now();
+            samples.push_back(duration_cast<nanoseconds>(end - start).count());
+        }
+    }
+    
+    // Help-desk pattern: every search follows a fresh registration
+    vector<long long> interleaved;
+    for (int i = 0; i < 2000; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "T%08d", i);
+        system.registerVoter(id, "Walk-in Voter");
+        page.clear();
+        auto start = high_resolution_clock::now();
+        system.searchVoters(true, "walk-in", 0, pageSize, page);
+        auto end = high_resolution_clock::now();
+        interleaved.push_back(duration_cast<nanoseconds>(end - start).count());
+    }
+    
+    // Linear scan reference for a sample of the queries
+    auto scanStart = high_resolution_clock::now();
+    bool match = true;
+    int checked = 0;
+    for (size_t q = 0; q < queries.size(); q += max<size_t>(1, queries.size() / 20), checked++) {
+        const string& prefix = queries[q].second;
+        size_t expected = 0;
+        for (int i = 0; i < voterCount; i++) {
+            const string& key = queries[q].first ? voterNames[i] : voterIDs[i];
+            if (key.size() < prefix.size()) continue;
+            size_t c = 0;
+            while (c < prefix.size() && tolower((unsigned char)key[c]) == tolower((unsigned char)prefix[c])) c++;
+            if (c == prefix.size()) expected++;
+        }
+        page.clear();
+        size_t total = system.searchVoters(queries[q].first, prefix, 0, voterCount, page);
+        if (total != expected || page.size() != expected) match = false;
+        for (size_t i = 0; i < page.size(); i++) {
+            const string& key = queries[q].first ? page[i]->name : page[i]->voterID;
+            for (size_t c = 0; c < prefix.size() && c < key.size(); c++) {
+                if (tolower((unsigned char)key[c]) != tolower((unsigned char)prefix[c])) match = false;
+            }
+        }
+    }
+    auto scanEnd = high_resolution_clock::now();
+    logFlush();
+    
+    cout << "\n+========================================+\n";
+    cout << "|     VOTER SEARCH BENCHMARK             |\n";
+    cout << "+========================================+\n";
+    cout << "  Voters: " << voterCount << "\n";
+    cout << "  Registration: " << fixed << setprecision(3)
+         << duration_cast<microseconds>(registerEnd - registerStart).count() / 1e6 << " s\n";
+    cout << "  Index build (first search): "
+         << duration_cast<microseconds>(buildEnd - buildStart).count() / 1e6 << " s\n";
+    cout << "  Linear scan: " << setprecision(2)
+         << duration_cast<microseconds>(scanEnd - scanStart).count() / 1000.0 / max(checked, 1)
+         << " ms per query\n\n";
+    cout << "  " << setw(22) << left << "Search latency (us)" << right << setw(10) << "Queries"
+         << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "max" << "\n";
+    vector<long long>* phases[] = {&firstPage, &laterPage, &interleaved};
+    const char* labels[] = {"top 20", "page 11", "after registration"};
+    for (int p = 0; p < 3; p++) {
+        vector<long long>& samples = *phases[p];
+        sort(samples.begin(), samples.end());
+        cout << "  " << setw(22) << left << labels[p] << right << setw(10) << samples.size();
+        if (samples.empty()) {
+            cout << "\n";
+            continue;
+        }
+        cout << setprecision(2) << setw(10) << samples[samples.size() / 2] / 1000.0
+             << setw(10) << samples[samples.size() * 99 / 100] / 1000.0
+             << setw(10) << samples.back() / 1000.0 << "\n";
+    }
+    cout << left << "\n  Results vs linear scan: " << (match ? "MATCH" : "MISMATCH")
+         << " (" << checked << " queries)\n\n";
+    return match ? 0 : 2;
+}
+
+// Tails a ledger replica written by another process: every new block must
+// carry valid hashes and link to the block before it. Runs until the writer
+// closes the replica and its last block has been verified.
+int runAuditor(const string& path) {
+    // The writer may still be starting; wait up to 30 s for the replica
+    int fd = -1;
+    for (int attempt = 0; attempt < 3000 && fd < 0; attempt++) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) usleep(10000);
+    }
+    if (fd < 0) {
+        logError("[ERROR] Cannot open ledger replica {}: {}", path, strerror(errno));
+        logFlush();
+        return 1;
+    }
+    struct stat info;
+    void* region = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(ReplicaHeader)) {
+        region = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (region == MAP_FAILED) {
+        logError("[ERROR] Cannot map ledger replica {}", path);
+        logFlush();
+        return 1;
+    }
+    const ReplicaHeader* header = (const ReplicaHeader*)region;
+    if (memcmp(header->magic, "EVREPL1\n", 8) != 0
+        || header->capacity > (unsigned long long)info.st_size - sizeof(ReplicaHeader)) {
+        logError("[ERROR] {} is not a ledger replica", path);
+        logFlush();
+        munmap(region, info.st_size);
+        return 1;
+    }
+    if (strncmp(header->preset, VotingSystem::presetName(), sizeof(header->preset)) != 0) {
+        logError("[ERROR] Replica was written by the {} preset; this auditor uses {}",
+                 string(header->preset, strnlen(header->preset, sizeof(header->preset))),
+                 VotingSystem::presetName());
+        logFlush();
+        munmap(region, info.st_size);
+        return 1;
+    }
+    const char* records = (const char*)region + sizeof(ReplicaHeader);
+    // The header is as untrusted as the records; bound every read by the
+    // capacity checked above, never by what the header says later
+    const unsigned long long capacity = header->capacity;
+    typedef VotingSystem::BlockHasher Hasher;
+    
+    logInfo("[AUDITOR] Tailing ledger replica {}", path);
+    logFlush();
+    unsigned long long offset = 0;
+    long long blocks = 0;
+    long long votes = 0;
+    long long alerts = 0;
+    unsigned long long maxLag = 0;
+    bool malformed = false;
+    string previousHash = "0";
+    vector<pair<string, long long> > tallies;
+    auto start = high_resolution_clock::now();
+    auto lastReport = start;
+    while (!malformed) {
+        unsigned long long committed = header->committedBytes.load(memory_order_acquire);
+        if (committed > capacity) {
+            logAlert("[ALERT] Replica claims {} committed bytes, beyond its {} byte capacity!", committed, capacity);
+            malformed = true;
+            break;
+        }
+        if (committed < offset) {
+            logAlert("[ALERT] Replica committed length went back from {} to {} bytes!", offset, committed);
+            malformed = true;
+            break;
+        }
+        if (offset == committed) {
+            // Closed or full, and nothing was published after the state change
+            if (header->state.load(memory_order_acquire) != REPLICA_OPEN
+                && header->committedBytes.load(memory_order_acquire) == offset) {
+                break;
+            }
+            usleep(1000);
+            continue;
+        }
+        maxLag = max(maxLag, header->committedBlocks.load(memory_order_relaxed) - (unsigned long long)blocks);
+        while (offset < committed && !malformed) {
+            unsigned long long length = 0;
+            if (committed - offset >= 4) {
+                for (int i = 0; i < 4; i++) {
+                    length |= (unsigned long long)(unsigned char)records[offset + i] << (8 * i);
+                }
+            }
+            if (committed - offset < 4 || length > committed - offset - 4 || offset + 4 + length > capacity) {
+                logAlert("[ALERT] Replica record after Block #{} is truncated!", blocks);
+                malformed = true;
+                break;
+            }
+            string record(records + offset + 4, length);
+            offset += 4 + length;
+            VoteRecord block;
+            try {
+                ByteReader in(record);
+                getBlock(in, block);
+                if (!in.atEnd()) throw runtime_error("trailing bytes");
+            } catch (const exception& e) {
+                logAlert("[ALERT] Replica record after Block #{} is malformed: {}", blocks, e.what());
+                malformed = true;
+                break;
+            }
+            blocks++;
+            votes += block.votes.size();
+            if (block.blockNumber != blocks || block.previousHash != previousHash) {
+                logAlert("[ALERT] Chain broken between Block #{} and #{}!", blocks - 1, block.blockNumber);
+                alerts++;
+            }
+            if (block.calculateTransactionsRoot<Hasher>() != block.transactionsRoot) {
+                logAlert("[ALERT] Votes in Block #{} have been tampered!", block.blockNumber);
+                alerts++;
+            } else if (block.calculateHash<Hasher>() != block.hash) {
+                logAlert("[ALERT] Block #{} has been tampered!", block.blockNumber);
+                alerts++;
+            }
+            previousHash = block.hash;
+            for (size_t i = 0; i < block.votes.size(); i++) {
+                string_view candidate = block.votes[i].candidate.view();
+                size_t c = 0;
+                while (c < tallies.size() && tallies[c].first != candidate) c++;
+                if (c == tallies.size()) tallies.push_back(make_pair(string(candidate), 0LL));
+                tallies[c].second++;
+            }
+        }
+        auto now = high_resolution_clock::now();
+        if (duration_cast<milliseconds>(now - lastReport).count() >= 1000) {
+            logInfo("[AUDITOR] Verified {} blocks ({} votes), {} alert(s)", blocks, votes, alerts);
+            logFlush();
+            lastReport = now;
+        }
+    }
+    int finalState = header->state.load(memory_order_acquire);
+    munmap(region, info.st_size);
+    auto end = high_resolution_clock::now();
+    if (malformed) alerts++;
+    logFlush();
+    
+    cout << "\n+========================================+\n";
+    cout << "|     LEDGER REPLICA AUDIT               |\n";
+    cout << "+========================================+\n";
+    cout << "  Replica: " << path << " (" << VotingSystem::presetName() << " preset)\n";
+    cout << "  Blocks verified: " << blocks << " (" << votes << " votes)\n";
+    for (size_t i = 0; i < tallies.size(); i++) {
+        cout << "    " << setw(20) << left << tallies[i].first << tallies[i].second << "\n";
+    }
+    cout << "  Largest backlog: " << maxLag << " block(s) behind the writer\n";
+    cout << "  Writer: " << (malformed ? "unknown (stopped at a bad record)"
+                              : finalState == REPLICA_FULL ? "replica full" : "closed") << "\n";
+    cout << "  Audit time: " << fixed << setprecision(3)
+         << duration_cast<microseconds>(end - start).count() / 1e6 << " s\n";
+    cout << "  Chain Status: " << (alerts == 0 ? "VALID (No tampering detected)"
+                                               : "INVALID (Tampering detected!)") << "\n\n";
+    return alerts == 0 ? 0 : 2;
+}
+
+// Starts "program --auditor path" as a separate process
+pid_t spawnAuditor(const char* program, const string& path, bool quiet) {
+    logFlush();
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (quiet) {
+            int devnull = open("/dev/null", O_WRONLY);
+            if (devnull >= 0) dup2(devnull, STDOUT_FILENO);
         }
+        execl("/proc/self/exe", program, "--auditor", path.c_str(), (char*)NULL);
+        _exit(127);
     }
-    
-public:
-    CandidateBST() : root(NULL) {}
-    
-    void addCandidate(string name) {
-        root = insert(root, name);
-        cout << "[SUCCESS] Candidate added: " << name << "\n";
+    return pid;
+}
+
+int waitForAuditor(pid_t pid) {
+    int status = 0;
+    if (pid <= 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+// Two-process replica check: vote at full speed while a separate auditor
+// process tails the published ledger, then make sure an auditor flags a
+// replica whose bytes were altered after publishing
+int runReplicaBenchmark(const char* program, int voteCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    const string path = "replica_bench.replica";
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    vector<string> voterIDs(voteCount);
+    for (int i = 0; i < voteCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "L%08d", i);
+        voterIDs[i] = id;
     }
     
-    bool addVote(string name) {
+    // Vote throughput with or without a replica, and with or without an auditor tailing it
+    auto runElection = [&](bool publish, bool audit, pid_t& auditor, unsigned long long& published) {
+        VotingSystem system;
+        system.initializeCandidates();
+        system.reserveBallots(voteCount);
+        for (int i = 0; i < voteCount; i++) {
+            system.registerVoter(voterIDs[i], "Voter");
+        }
+        if (publish) {
+            remove(path.c_str());
+            if (audit) auditor = spawnAuditor(program, path, false);
+            if (!system.startReplica(path, (unsigned long long)voteCount * 64 + (1 << 20))) return -1.0;
+        }
         auto start = high_resolution_clock::now();
-        CandidateNode* candidate = search(root, name);
-        auto end = high_resolution_clock::now();
-        auto duration = duration_cast<microseconds>(end - start);
-        if (candidate == NULL) {
-            return false;
+        for (int i = 0; i < voteCount; i++) {
+            system.castVote(voterIDs[i], names[i % 4]);
         }
-        candidate->voteCount++;
-        int height = getHeight(root);
-        cout << "          [TIME] BST Search: " << duration.count() << " microseconds\n";
-        cout << "          Tree Height: " << height << " | Time Complexity: O(log n) avg, O(" << height << ") this case\n";
-        return true;
-    }
-    
-    void displayResults() {
-        cout << "\n+========================================+\n";
-        cout << "|       ELECTION RESULTS                 |\n";
-        cout << "+========================================+\n";
-        inorder(root);
-        cout << "\n  Total votes: " << getTotalVotes(root) << "\n";
-        cout << "  BST Height: " << getHeight(root) << "\n";
-        cout << "  Inorder Traversal: O(n) where n = number of candidates\n\n";
-    }
+        system.commitLedger();
+        auto end = high_resolution_clock::now();
+        published = system.getLedgerBlocks();
+        system.stopReplica();
+        return duration_cast<microseconds>(end - start).count() / 1e6;
+    };
+    pid_t auditor = -1;
+    unsigned long long blocks = 0;
+    double baselineSeconds = runElection(false, false, auditor, blocks);
+    double writerSeconds = runElection(true, false, auditor, blocks);
+    double replicaSeconds = runElection(true, true, auditor, blocks);
+    if (replicaSeconds < 0 && auditor > 0) kill(auditor, SIGTERM);
+    int auditorStatus = waitForAuditor(auditor);
+    remove(path.c_str());
     
-    void displayPercentages() {
-        int total = getTotalVotes(root);
-        if (total == 0) {
-            cout << "No votes cast yet.\n";
-            return;
+    // Flip one candidate name inside the published records of a closed replica
+    const string tamperedPath = "replica_tamper.replica";
+    bool tampered = false;
+    {
+        VotingSystem system;
+        system.initializeCandidates();
+        for (int i = 0; i < 1000 && i < voteCount; i++) {
+            system.registerVoter(voterIDs[i], "Voter");
+            system.castVote(voterIDs[i], names[i % 4]);
+        }
+        if (system.startReplica(tamperedPath, 1 << 20)) {
+            system.stopReplica();
+            FILE* file = fopen(tamperedPath.c_str(), "r+b");
+            if (file != NULL) {
+                string data(sizeof(ReplicaHeader) + (1 << 20), '\0');
+                data.resize(fread(&data[0], 1, data.size(), file));
+                size_t at = data.find("Kashan", sizeof(ReplicaHeader));
+                if (at != string::npos && fseek(file, (long)at + 4, SEEK_SET) == 0) {
+                    tampered = fputc('b', file) != EOF;
+                }
+                tampered = (fclose(file) == 0) && tampered;
+            }
         }
-        cout << "\n+========================================+\n";
-        cout << "|       VOTE PERCENTAGES                 |\n";
-        cout << "+========================================+\n";
-        displayPercent(root, total);
-        cout << "\n";
     }
+    int tamperStatus = tampered ? waitForAuditor(spawnAuditor(program, tamperedPath, true)) : -1;
+    remove(tamperedPath.c_str());
+    logFlush();
     
-    bool candidateExists(string name) {
-        return search(root, name) != NULL;
+    bool ok = writerSeconds >= 0 && replicaSeconds >= 0 && auditorStatus == 0 && tamperStatus == 2;
+    cout << "\n+========================================+\n";
+    cout << "|     LEDGER REPLICA BENCHMARK           |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << " | Cores: " << defaultThreadCount() << "\n";
+    cout << "  Votes: " << voteCount << " in " << blocks << " published blocks\n";
+    cout << "  Without replica: " << fixed << setprecision(0)
+         << (baselineSeconds > 0 ? voteCount / baselineSeconds : 0) << " votes/s\n";
+    cout << "  With replica: " << (writerSeconds > 0 ? voteCount / writerSeconds : 0) << " votes/s\n";
+    cout << "  With replica + auditor process: "
+         << (replicaSeconds > 0 ? voteCount / replicaSeconds : 0) << " votes/s\n";
+    cout << "  Live auditor: " << (auditorStatus == 0 ? "VALID" : auditorStatus == 2 ? "ALERTS RAISED" : "FAILED")
+         << " (exit " << auditorStatus << ")\n";
+    cout << "  Tampered replica: " << (tamperStatus == 2 ? "ALERT raised" : "NOT DETECTED")
+         << " (exit " << tamperStatus << ")\n";
+    cout << "  Status: " << (ok ? "OK" : "FAILED") << "\n\n";
+    return ok ? 0 : 2;
+}
+
+// Open-loop ingestion: votes arrive at a fixed rate while an audit, save,
+// export and checkpoint of the election run and a burst of registrations
+// lands. FIFO mode serves every request to completion in arrival order, as
+// the menu does; scheduled mode admits them through VoteScheduler, and
+// rejected registrations come back after their retry hint.
+int runSchedulerBenchmark(int voterCount) {
+    const string names[] = {"Akram", "Kashan", "Mubashir", "Suleman"};
+    const long long VOTE_RATE = 100000;   // arrivals per second
+    const long long SLO_MICROS = 1000;    // p99 vote latency target
+    const string prefix = "scheduler_bench";
+    AsyncLogger::instance().setLevel(LOG_WARN);
+    int preloaded = voterCount / 2;
+    int liveVotes = voterCount - preloaded;
+    int burst = max(voterCount / 20, 1);
+    vector<string> voterIDs(voterCount);
+    vector<string> burstIDs(burst);
+    for (int i = 0; i < voterCount; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "Q%07d", i);
+        voterIDs[i] = id;
     }
-    
-    ~CandidateBST() {
-        destroy(root);
+    for (int i = 0; i < burst; i++) {
+        char id[16];
+        snprintf(id, sizeof(id), "R%07d", i);
+        burstIDs[i] = id;
     }
-};
-
-// Main voting system
-class VotingSystem {
-private:
-    VoterHashTable voterDB;
-    VoteLedger ledger;
-    CandidateBST candidates;
-    bool candidatesInitialized;
     
-public:
-    VotingSystem() : candidatesInitialized(false) {}
+    // Arrival schedule, in microseconds from the start of the run
+    long long runMicros = liveVotes * 1000000LL / VOTE_RATE;
+    long long burstAt = runMicros / 5;
+    const int EVENTS = 4;
+    long long eventAt[EVENTS] = {runMicros / 10, runMicros * 3 / 10, runMicros / 2, runMicros * 7 / 10};
+    AdminTask eventTask[EVENTS] = {ADMIN_AUDIT, ADMIN_SAVE, ADMIN_EXPORT, ADMIN_CHECKPOINT};
+    string eventTarget[EVENTS] = {"", prefix + ".dat", prefix, prefix + ".ckpt"};
+    auto voteAt = [&](int i) { return i * 1000000LL / VOTE_RATE; };
+    // Both modes start without earlier output, so neither pays to free the other's files
+    auto removeOutputs = [&]() {
+        const char* outputs[] = {".dat", ".dat.old", ".ckpt", "_ledger.csv", "_ledger.evc", "_tallies.csv", "_turnout.csv"};
+        for (const char* suffix : outputs) {
+            remove((prefix + suffix).c_str());
+        }
+    };
     
-    void initializeCandidates() {
-        if (!candidatesInitialized) {
-            candidates.addCandidate("Akram");
-            candidates.addCandidate("Kashan");
-            candidates.addCandidate("Mubashir");
-            candidates.addCandidate("Suleman");
-            candidatesInitialized = true;
+    struct ModeResult {
+        LatencyHistogram votes;
+        LatencyHistogram admin;
+        long long rejected;
+        long long retried;
+        double seconds;
+        bool valid;
+        
+        ModeResult() : rejected(0), retried(0), seconds(0), valid(false) {}
+    };
+    
+    auto setup = [&](VotingSystem& system) {
+        system.initializeCandidates();
+        for (int i = 0; i < voterCount; i++) {
+            system.registerVoter(voterIDs[i], "Voter " + voterIDs[i]);
         }
-    }
+        system.reserveBallots(voterCount);
+        for (int i = 0; i < preloaded; i++) {
+            system.castVote(voterIDs[i], names[i % 4]);
+        }
+        system.commitLedger();
+    };
+    auto finish = [&](VotingSystem& system, ModeResult& result, high_resolution_clock::time_point start) {
+        system.finishExport();
+        system.finishCheckpoint();
+        system.commitLedger();
+        result.seconds = duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1e6;
+        result.valid = system.verifyLedger() && system.getVotedCount() == voterCount
+                       && system.getTotalVoters() == voterCount + burst;
+    };
     
-    void registerVoter(string id, string name) {
-        voterDB.insertVoter(id, name);
+    ModeResult direct;
+    removeOutputs();
+    {
+        VotingSystem system;
+        setup(system);
+        int nextVote = 0, nextEvent = 0;
+        bool burstDone = false;
+        auto start = high_resolution_clock::now();
+        while (nextVote < liveVotes || nextEvent < EVENTS || !burstDone) {
+            long long now = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+            long long dueVote = nextVote < liveVotes ? voteAt(nextVote) : numeric_limits<long long>::max();
+            long long dueEvent = nextEvent < EVENTS ? eventAt[nextEvent] : numeric_limits<long long>::max();
+            long long dueBurst = burstDone ? numeric_limits<long long>::max() : burstAt;
+            long long due = min(dueVote, min(dueEvent, dueBurst));
+            if (due > now) continue;
+            if (due == dueBurst) {
+                for (int i = 0; i < burst; i++) {
+                    system.registerVoter(burstIDs[i], "Voter " + burstIDs[i]);
+                }
+                burstDone = true;
+            } else if (due == dueEvent) {
+                switch (eventTask[nextEvent]) {
+                    case ADMIN_AUDIT: system.auditBlockchain(); break;
+                    case ADMIN_SAVE: system.saveData(eventTarget[nextEvent]); break;
+                    case ADMIN_EXPORT: system.startExport(eventTarget[nextEvent]); break;
+                    case ADMIN_CHECKPOINT: system.startCheckpoint(eventTarget[nextEvent]); break;
+                }
+                direct.admin.record(duration_cast<microseconds>(high_resolution_clock::now() - start).count() - due);
+                nextEvent++;
+            } else {
+                system.castVote(voterIDs[preloaded + nextVote], names[nextVote % 4]);
+                direct.votes.record(duration_cast<microseconds>(high_resolution_clock::now() - start).count() - due);
+                nextVote++;
+            }
+        }
+        finish(system, direct, start);
     }
     
-    void castVote(string voterID, string candidate) {
-        cout << "\n========== VOTE CASTING PROCESS ==========\n";
-        auto totalStart = high_resolution_clock::now();
-        try {
-            if (!voterDB.authenticateVoter(voterID)) {
-                throw runtime_error("Authentication failed!");
-            }
-            Voter* voter = voterDB.findVoter(voterID);
-            if (voter == NULL) {
-                throw runtime_error("Voter not found!");
+    ModeResult scheduled;
+    long long registrationsRejected = 0;
+    removeOutputs();
+    {
+        VotingSystem system;
+        setup(system);
+        VoteScheduler scheduler(system);
+        vector<pair<long long, int> > retries;   // min-heap of (retry time, burst index)
+        int nextVote = 0, nextEvent = 0;
+        bool burstDone = false;
+        auto start = high_resolution_clock::now();
+        auto submitRegistration = [&](int i, long long now) {
+            Admission admission = scheduler.submitRegistration(burstIDs[i], "Voter " + burstIDs[i],
+                                                               start + microseconds(burstAt));
+            if (admission.status != REJECTED_FULL) return;
+            retries.push_back(make_pair(now + admission.retryAfterMicros, i));
+            push_heap(retries.begin(), retries.end(), greater<pair<long long, int> >());
+        };
+        while (nextVote < liveVotes || nextEvent < EVENTS || !burstDone || !retries.empty()
+               || scheduler.getQueued(WORK_VOTE) > 0 || scheduler.getQueued(WORK_REGISTRATION) > 0
+               || scheduler.getQueued(WORK_ADMIN) > 0) {
+            long long now = duration_cast<microseconds>(high_resolution_clock::now() - start).count();
+            for (; nextVote < liveVotes && voteAt(nextVote) <= now; nextVote++) {
+                Admission admission = scheduler.submitVote(voterIDs[preloaded + nextVote], names[nextVote % 4],
+                                                           start + microseconds(voteAt(nextVote)));
+                if (admission.status != ADMITTED) scheduled.rejected++;
             }
-            if (voter->hasVoted) {
-                throw runtime_error("You have already voted!");
+            if (!burstDone && burstAt <= now) {
+                for (int i = 0; i < burst; i++) submitRegistration(i, now);
+                burstDone = true;
             }
-            if (!candidates.candidateExists(candidate)) {
-                throw runtime_error("Invalid candidate!");
+            while (!retries.empty() && retries.front().first <= now) {
+                int i = retries.front().second;
+                pop_heap(retries.begin(), retries.end(), greater<pair<long long, int> >());
+                retries.pop_back();
+                scheduled.retried++;
+                submitRegistration(i, now);
             }
-            if (!voterDB.markAsVoted(voterID)) {
-                throw runtime_error("Failed to mark as voted");
+            for (; nextEvent < EVENTS && eventAt[nextEvent] <= now; nextEvent++) {
+                scheduler.submitAdmin(eventTask[nextEvent], eventTarget[nextEvent], start + microseconds(eventAt[nextEvent]));
             }
-            ledger.addVote(voterID, candidate);
-            candidates.addVote(candidate);
-            auto totalEnd = high_resolution_clock::now();
-            auto totalDuration = duration_cast<microseconds>(totalEnd - totalStart);
-            cout << "\n[SUCCESS] Vote successfully cast for " << candidate << "!\n";
-            cout << "==========================================\n";
-            cout << "[TOTAL TIME] Complete voting process: " << totalDuration.count() << " microseconds\n";
-            cout << "             (" << fixed << setprecision(3) << totalDuration.count() / 1000.0 << " milliseconds)\n";
-            cout << "==========================================\n\n";
-        } catch (const exception& e) {
-            cout << "[ERROR] " << e.what() << "\n";
+            scheduler.dispatch();
         }
+        scheduled.votes = scheduler.getStats(WORK_VOTE).latency;
+        scheduled.admin = scheduler.getStats(WORK_ADMIN).latency;
+        registrationsRejected = scheduler.getStats(WORK_REGISTRATION).rejected;
+        scheduled.valid = scheduler.getStats(WORK_ADMIN).failed == 0;
+        finish(system, scheduled, start);
+        scheduled.valid = scheduled.valid && scheduler.getStats(WORK_ADMIN).completed == EVENTS;
+        logFlush();
+        scheduler.displayStats();
     }
+    removeOutputs();
+    logFlush();
     
-    void showResults() { candidates.displayResults(); }
-    void showPercentages() { candidates.displayPercentages(); }
-    void showVoters() { voterDB.displayAllVoters(); }
-    void showLedger() { ledger.displayLedger(); }
-    void showHashStats() { voterDB.displayHashTableStats(); }
-    void auditBlockchain() { ledger.auditBlockchain(); }
-    
-    void showDashboard() {
-        cout << "\n+========================================+\n";
-        cout << "|       ADMIN DASHBOARD                  |\n";
-        cout << "+========================================+\n";
-        int total = voterDB.getTotalVoters();
-        int voted = voterDB.getVotedCount();
-        cout << "  Total Registered: " << total << "\n";
-        cout << "  Votes Cast: " << voted << "\n";
-        cout << "  Not Voted: " << (total - voted) << "\n";
-        if (total > 0) {
-            cout << "  Turnout: " << fixed << setprecision(1)
-                 << (voted * 100.0 / total) << "%\n";
+    bool valid = direct.valid && scheduled.valid;
+    bool sloMet = scheduled.votes.percentile(99) <= SLO_MICROS;
+    cout << "\n+========================================+\n";
+    cout << "|     ADMISSION CONTROL BENCHMARK        |\n";
+    cout << "+========================================+\n";
+    cout << "  Preset: " << VotingSystem::presetName() << " | Cores: " << defaultThreadCount() << "\n";
+    cout << "  Voters: " << voterCount << " (" << preloaded << " voted before the run)\n";
+    cout << "  Live votes: " << liveVotes << " at " << VOTE_RATE << "/s, registration burst: " << burst << "\n";
+    cout << "  Admin jobs: audit, save, export, checkpoint | Vote p99 SLO: " << SLO_MICROS << " us\n\n";
+    cout << "  " << setw(11) << left << "Mode" << right << setw(10) << "p50 us" << setw(10) << "p99 us"
+         << setw(10) << "max us" << setw(7) << "SLO" << setw(12) << "Admin max" << setw(10) << "Run s" << "\n";
+    ModeResult* modes[] = {&direct, &scheduled};
+    const char* labels[] = {"FIFO", "Scheduled"};
+    for (int m = 0; m < 2; m++) {
+        ModeResult& result = *modes[m];
+        cout << "  " << setw(11) << left << labels[m] << right << setw(10) << result.votes.percentile(50)
+             << setw(10) << result.votes.percentile(99) << setw(10) << result.votes.getMax()
+             << setw(7) << (result.votes.percentile(99) <= SLO_MICROS ? "met" : "MISSED")
+             << setw(9) << fixed << setprecision(1) << result.admin.getMax() / 1000.0 << " ms"
+             << setw(10) << setprecision(2) << result.seconds << "\n";
+    }
+    cout << left << "\n  Registrations rejected while full: " << registrationsRejected
+         << " (" << scheduled.retried << " retries after the hint)\n";
+    cout << "  Votes rejected while full: " << scheduled.rejected << "\n";
+    if (!valid) {
+        cout << "  Status: FAILED (ledger, vote, registration or admin job check failed)\n\n";
+    } else if (!sloMet) {
+        cout << "  Status: FAILED (scheduled vote p99 " << scheduled.votes.percentile(99) << " us misses the "
+             << SLO_MICROS << " us SLO; work was complete and ledgers verified)\n\n";
+    } else {
+        cout << "  Status: OK (SLO met, ledgers verified, every vote, registration and admin job completed)\n\n";
+    }
+    return valid && sloMet ? 0 : 2;
+}
+
+void showUsage(const char* program) {
+    cout << "Usage: " << program << " [option]\n";
+    cout << "  (no option)              Interactive menu\n";
+    cout << "  --shards N [VOTERS]      Sharded election across N shard processes\n";
+    cout << "  --shards N,M,... [VOTERS] Sweep shard counts and compare votes/s\n";
+    cout << "  --ledger-bench [VOTES]   Ledger throughput for several block sizes\n";
+    cout << "  --bench [VOTERS]         Register/vote throughput of the compiled preset\n";
+    cout << "  --irv-bench [BALLOTS]    Instant-runoff tabulation over synthetic ballots\n";
+    cout << "  --export-bench [BLOCKS]  CSV + columnar export of a one-vote-per-block ledger\n";
+    cout << "  --alloc-check [VOTERS]   Count allocations per castVote (build with -DEVOTING_ALLOC_CHECK)\n";
+    cout << "  --snapshot-bench [VOTERS] Vote latency during a checkpoint, then verify restore\n";
+    cout << "  --recovery-bench [VOTES] Time rebuilding tallies and flags from a checkpointed ledger\n";
+    cout << "  --search-bench [VOTERS]  Prefix search latency over registered IDs and names\n";
+    cout << "  --replica [PATH]         Interactive menu, publishing sealed blocks to PATH (default ledger.replica)\n";
+    cout << "  --auditor [PATH]         Tail and verify the ledger replica (default ledger.replica)\n";
+    cout << "  --replica-bench [VOTES]  Vote under load with a separate auditor process tailing the replica\n";
+    cout << "  --scheduler-bench [VOTERS] Vote latency under admin jobs, FIFO vs admission control\n";
+}
+
+// Non-interactive modes
+int runCommandLine(int argc, char* argv[]) {
+    string mode = argv[1];
+    if (mode == "--shards" && argc >= 3) {
+        vector<string> counts = splitFields(argv[2], ',');
+        vector<int> shardCounts;
+        for (size_t i = 0; i < counts.size(); i++) shardCounts.push_back(atoi(counts[i].c_str()));
+        int voterCount = (argc >= 4) ? atoi(argv[3]) : 100000;
+        if (shardCounts.empty() || *min_element(shardCounts.begin(), shardCounts.end()) < 1 || voterCount < 0) {
+            showUsage(argv[0]);
+            return 1;
         }
-        cout << "  Blockchain Blocks: " << ledger.getTotalVotes() << "\n";
-        cout << "  Security: " << (ledger.verifyChain() ? "SECURE" : "COMPROMISED") << "\n\n";
+        if (shardCounts.size() > 1) return runShardSweep(shardCounts, voterCount);
+        return runShardedElection(shardCounts[0], voterCount);
     }
-    
-    void showTimeComplexityAnalysis() {
-        cout << "\n+========================================+\n";
-        cout << "|   TIME COMPLEXITY ANALYSIS             |\n";
-        cout << "+========================================+\n";
-        cout << "\n1. HASH TABLE (Voter Database):\n";
-        cout << "   - Insert:  O(1) average (amortized), O(n) worst\n";
-        cout << "   - Search:  O(1) average, O(n) worst\n";
-        cout << "   - Delete:  O(1) average, O(n) worst\n";
-        cout << "   - Resize:  O(n) - rehash all elements\n";
-        cout << "   * n = chain length at index\n";
-        cout << "   * Amortized O(1) due to dynamic resizing\n";
-        cout << "\n2. BLOCKCHAIN (Vote Ledger):\n";
-        cout << "   - Insert:  O(1) - append to end\n";
-        cout << "   - Verify:  O(n) - check all blocks\n";
-        cout << "   - Search:  O(n) - linear traversal\n";
-        cout << "   * n = number of blocks\n";
-        cout << "\n3. BINARY SEARCH TREE (Candidates):\n";
-        cout << "   - Insert:  O(log n) average, O(n) worst\n";
-        cout << "   - Search:  O(log n) average, O(n) worst\n";
-        cout << "   - Traverse: O(n) - visit all nodes\n";
-        cout << "   * n = number of candidates\n";
-        cout << "\n4. COMPLETE VOTING OPERATION:\n";
-        cout << "   Total = O(1) amortized + O(1) + O(log n)\n";
-        cout << "   Result: O(log n) overall\n";
-        cout << "+========================================+\n\n";
+    if (mode == "--ledger-bench") {
+        int voteCount = (argc >= 3) ? atoi(argv[2]) : 200000;
+        if (voteCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runLedgerBenchmark(voteCount);
     }
-    
-    bool saveData() {
-        cout << "\n[SAVING] Saving system data...\n";
-        bool success = voterDB.saveToFile("voters.dat");
-        if (success) {
-            cout << "[SUCCESS] Data saved successfully!\n\n";
+    if (mode == "--bench") {
+        int voterCount = (argc >= 3) ? atoi(argv[2]) : 200000;
+        if (voterCount < 0) {
+            showUsage(argv[0]);
+            return 1;
         }
-        return success;
+        return runSystemBenchmark(voterCount);
     }
-    
-    bool loadData() {
-        cout << "\n[LOADING] Loading system data...\n";
-        bool success = voterDB.loadFromFile("voters.dat");
-        if (success) {
-            cout << "[SUCCESS] Data loaded successfully!\n\n";
+    if (mode == "--irv-bench") {
+        long long ballotCount = (argc >= 3) ? atoll(argv[2]) : 10000000;
+        if (ballotCount < 0) {
+            showUsage(argv[0]);
+            return 1;
         }
-        return success;
+        return runRunoffBenchmark(ballotCount);
     }
-};
+    if (mode == "--recovery-bench") {
+        int voteCount = (argc >= 3) ? atoi(argv[2]) : 5000000;
+        if (voteCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runRecoveryBenchmark(voteCount);
+    }
+    if (mode == "--snapshot-bench") {
+        int voterCount = (argc >= 3) ? atoi(argv[2]) : 1000000;
+        if (voterCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runSnapshotBenchmark(voterCount);
+    }
+    if (mode == "--alloc-check") {
+        int voterCount = (argc >= 3) ? atoi(argv[2]) : 100000;
+        if (voterCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runAllocationCheck(voterCount);
+    }
+    if (mode == "--auditor") {
+        return runAuditor(argc >= 3 ? argv[2] : "ledger.replica");
+    }
+    if (mode == "--replica-bench") {
+        int voteCount = (argc >= 3) ? atoi(argv[2]) : 1000000;
+        if (voteCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runReplicaBenchmark(argv[0], voteCount);
+    }
+    if (mode == "--scheduler-bench") {
+        int voterCount = (argc >= 3) ? atoi(argv[2]) : 400000;
+        if (voterCount < 2) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runSchedulerBenchmark(voterCount);
+    }
+    if (mode == "--search-bench") {
+        int voterCount = (argc >= 3) ? atoi(argv[2]) : 1000000;
+        if (voterCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runSearchBenchmark(voterCount);
+    }
+    if (mode == "--export-bench") {
+        int blockCount = (argc >= 3) ? atoi(argv[2]) : 500000;
+        if (blockCount < 0) {
+            showUsage(argv[0]);
+            return 1;
+        }
+        return runExportBenchmark(blockCount);
+    }
+    showUsage(argv[0]);
+    return 1;
+}
 
-void showBanner() {
-    cout << "\n";
-    cout << "+========================================+\n";
-    cout << "|                                        |\n";
-    cout << "|     SECURE E-VOTING SYSTEM             |\n";
-    cout << "|                                        |\n";
-    cout << "|   Blockchain - Hash Table - BST        |\n";
-    cout << "|   WITH TIME COMPLEXITY ANALYSIS        |\n";
-    cout << "|                                        |\n";
-    cout << "+========================================+\n";
+// "Akram, Kashan, Suleman" -> {"Akram", "Kashan", "Suleman"}
+vector<string> parseRanking(const string& line) {
+    vector<string> ranking;
+    vector<string> fields = splitFields(line, ',');
+    for (size_t i = 0; i < fields.size(); i++) {
+        size_t first = fields[i].find_first_not_of(" \t");
+        if (first == string::npos) continue;
+        size_t last = fields[i].find_last_not_of(" \t\r");
+        ranking.push_back(fields[i].substr(first, last - first + 1));
+    }
+    return ranking;
 }
 
-void showMenu() {
-    cout << "\n+========================================+\n";
-    cout << "|          MAIN MENU                     |\n";
-    cout << "+========================================+\n";
-    cout << "| VOTER OPERATIONS:                      |\n";
-    cout << "|  1. Register New Voter                 |\n";
-    cout << "|  2. Cast Vote (with timing)            |\n";
-    cout << "|  3. View Election Results              |\n";
-    cout << "|  4. View Vote Percentages              |\n";
-    cout << "|  5. View Registered Voters             |\n";
-    cout << "|                                        |\n";
-    cout << "| BLOCKCHAIN & SECURITY:                 |\n";
-    cout << "|  6. View Blockchain Ledger             |\n";
-    cout << "|  7. Audit Blockchain Security          |\n";
-    cout << "|                                        |\n";
-    cout << "| ADMIN & ANALYSIS:                      |\n";
-    cout << "|  8. Admin Dashboard                    |\n";
-    cout << "|  9. Hash Table Statistics              |\n";
-    cout << "| 10. Time Complexity Analysis           |\n";
-    cout << "|                                        |\n";
-    cout << "| FILE OPERATIONS:                       |\n";
-    cout << "| 11. Save Data                          |\n";
-    cout << "| 12. Load Data                          |\n";
-    cout << "|                                        |\n";
-    cout << "|  0. Exit                               |\n";
-    cout << "+========================================+\n";
-    cout << "\nEnter choice: ";
+// Rename `path` to <path>.<tag>-<mtime> so a later save cannot replace it;
+// returns the new name, or "" if it could not be moved
+string moveAside(const string& path, const char* tag) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return "";
+    string kept = path + "." + tag + "-" + to_string((long long)info.st_mtim.tv_sec);
+    return rename(path.c_str(), kept.c_str()) == 0 ? kept : "";
 }
 
-// input handling
-int getMenuChoice() {
-    int choice;
-    while (true) {
-        if (cin >> choice) {
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Clear entire buffer
-            return choice;
-        } else {
-            cin.clear();  // Clear error flags
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Discard bad input
-            cout << "[ERROR] Invalid input! Please enter a number: ";
-        }
+// The checkpoint carries the ledger, so startup restores it in preference
+// to voters.dat. Voter data saved after it (by a scheduled save job, or
+// copied in by hand) would then be overwritten on exit; move it aside
+// instead and say where it went.
+void keepNewerVoterData(const string& dataPath, const string& checkpointPath) {
+    struct stat data, checkpoint;
+    if (stat(dataPath.c_str(), &data) != 0 || stat(checkpointPath.c_str(), &checkpoint) != 0) return;
+    if (data.st_mtim.tv_sec < checkpoint.st_mtim.tv_sec
+        || (data.st_mtim.tv_sec == checkpoint.st_mtim.tv_sec && data.st_mtim.tv_nsec <= checkpoint.st_mtim.tv_nsec)) {
+        return;
     }
+    string kept = moveAside(dataPath, "newer");
+    if (kept.empty()) {
+        logAlert("[ALERT] {} is newer than {} but could not be moved aside: {}",
+                 dataPath, checkpointPath, strerror(errno));
+        return;
+    }
+    logAlert("[ALERT] {} is newer than {}; restoring the checkpoint and keeping the newer voter data as {}",
+             dataPath, checkpointPath, kept);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    string replicaPath;
+    if (argc > 1 && string(argv[1]) == "--replica" && argc <= 3) {
+        replicaPath = argc == 3 ? argv[2] : "ledger.replica";
+    } else if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
     showBanner();
     VotingSystem system;
     
-    cout << "\n[INIT] Initializing system...\n";
+    logInfo("\n[INIT] Initializing system...");
     
     // initialize candidates
     system.initializeCandidates();
     
-    //load voter data
-    if (system.loadData()) {
-        cout << "[INFO] Previous voter data loaded successfully.\n";
+    //load the last checkpoint, falling back to voter data
+    keepNewerVoterData("voters.dat", "system.ckpt");
+    bool restored = system.restoreCheckpoint();
+    bool checkpointWritable = true;
+    if (!restored && access("system.ckpt", F_OK) == 0) {
+        // The ledger exists only in the checkpoint; never let a save replace it
+        string kept = moveAside("system.ckpt", "bad");
+        if (kept.empty()) {
+            checkpointWritable = false;
+            logAlert("[ALERT] system.ckpt could not be restored or moved aside: {}; it will not be overwritten",
+                     strerror(errno));
+        } else {
+            logAlert("[ALERT] system.ckpt could not be restored; kept as {} and starting from voter data", kept);
+        }
+    }
+    if (restored) {
+        logInfo("[INFO] Previous system state restored from checkpoint.");
+    } else if (system.loadData()) {
+        logInfo("[INFO] Previous voter data loaded successfully.");
     } else {
-        cout << "[INFO] No saved data found. Starting fresh.\n";
-        cout << "\n[SETUP] Adding sample voters...\n";
+        logInfo("[INFO] No saved data found. Starting fresh.");
+        logInfo("\n[SETUP] Adding sample voters...");
         system.registerVoter("V001", "Abbad Ahmed");
         system.registerVoter("V002", "Talal Khan");
         system.registerVoter("V003", "Haziq Ali");
     }
     
+    // With --replica, sealed blocks are mirrored for "--auditor" processes
+    if (!replicaPath.empty()) {
+        system.startReplica(replicaPath);
+    }
+    
     string id, name, candidate;
     
     while (true) {
         try {
+            logFlush();
             showMenu();
-            int choice = getMenuChoice();
+            int choice = getMenuChoice(system);
             
             switch (choice) {
                 case 1:
@@ -939,16 +6565,84 @@ int main() {
                     break;
                     
                 case 11:
+                    // The checkpoint is what startup restores, so keep it as fresh
                     system.saveData();
+                    system.finishCheckpoint();
+                    if (checkpointWritable) {
+                        system.startCheckpoint();
+                        system.finishCheckpoint();
+                    }
                     break;
                     
                 case 12:
                     system.loadData();
                     break;
                     
+                case 13:
+                    cout << "\n--- CAST RANKED VOTE ---\n";
+                    cout << "Enter your Voter ID: ";
+                    getline(cin, id);
+                    cout << "\nAvailable Candidates:\n";
+                    cout << "  - Akram\n  - Kashan\n  - Mubashir\n  - Suleman\n";
+                    cout << "\nEnter candidates in order of preference (comma separated): ";
+                    getline(cin, candidate);
+                    system.castRankedVote(id, parseRanking(candidate));
+                    break;
+                    
+                case 14:
+                    system.showRankedResults();
+                    break;
+                    
+                case 15:
+                    system.startExport();
+                    break;
+                    
+                case 16:
+                    if (checkpointWritable) {
+                        system.startCheckpoint();
+                    } else {
+                        logError("[ERROR] system.ckpt could not be restored; it will not be overwritten");
+                    }
+                    break;
+                    
+                case 17:
+                    cout << "\n--- HISTORICAL RESULTS ---\n";
+                    cout << "Enter block number or time of day (HH:MM): ";
+                    getline(cin, id);
+                    system.showHistoricalResults(id);
+                    break;
+                    
+                case 18: {
+                    cout << "\n--- SEARCH VOTERS ---\n";
+                    cout << "Search by (1) Voter ID or (2) Name: ";
+                    getline(cin, candidate);
+                    bool byName = candidate == "2";
+                    cout << "Enter prefix (blank lists everyone): ";
+                    getline(cin, id);
+                    size_t page = 0;
+                    while (true) {
+                        size_t pages = system.showVoterSearch(byName, id, page);
+                        if (pages <= 1) break;
+                        cout << "[n]ext page, [p]revious page, or Enter to return: ";
+                        getline(cin, name);
+                        if (name == "n" && page + 1 < pages) page++;
+                        else if (name == "p" && page > 0) page--;
+                        else if (name != "n" && name != "p") break;
+                    }
+                    break;
+                }
+                    
                 case 0:
-                    cout << "\n[EXIT] Saving and exiting...\n";
+                    logInfo("\n[EXIT] Saving and exiting...");
                     system.saveData();
+                    system.finishCheckpoint();
+                    if (checkpointWritable) {
+                        system.startCheckpoint();
+                        system.finishCheckpoint();
+                    }
+                    system.finishExport();
+                    system.stopReplica();
+                    logFlush();
                     cout << "Thank you for using E-Voting System!\n\n";
                     return 0;
                     
@@ -957,7 +6651,7 @@ int main() {
             }
             
         } catch (const exception& e) {
-            cout << "[ERROR] " << e.what() << "\n";
+            logError("[ERROR] {}", e.what());
             cin.clear();
             cin.ignore(numeric_limits<streamsize>::max(), '\n');
         }